@@ -0,0 +1,104 @@
+#include "AllocCounter.h"
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+namespace {
+[[noreturn]] void out_of_memory() {
+#if defined(__cpp_exceptions) || defined(__EXCEPTIONS) || (defined(_MSC_VER) && defined(_CPPUNWIND))
+  throw std::bad_alloc();
+#else
+  std::abort();
+#endif
+}
+
+std::atomic<std::size_t> g_count{0};
+std::atomic<std::size_t> g_bytes{0};
+std::atomic<std::size_t> g_frees{0};
+
+// The calling thread's counts, and its innermost `NoAllocGuard` and number of guards in
+// `Fail` mode. All are constant-initialized, so using them in `operator new` can't allocate.
+thread_local bench::AllocStats    t_stats;
+thread_local bench::NoAllocGuard* t_guard   = nullptr;
+thread_local unsigned             t_failing = 0;
+
+void count_alloc(std::size_t size) noexcept {
+  g_count.fetch_add(1, std::memory_order_relaxed);
+  g_bytes.fetch_add(size, std::memory_order_relaxed);
+  ++t_stats.count;
+  t_stats.bytes += size;
+  if (t_failing != 0) {
+    t_failing = 0; // in case reporting allocates
+    std::fprintf(stderr, "NoAllocGuard: allocation of %zu bytes in %s\n", size, t_guard->what());
+    std::abort();
+  }
+}
+
+void count_free(void* p) noexcept {
+  if (p != nullptr) {
+    g_frees.fetch_add(1, std::memory_order_relaxed);
+    ++t_stats.frees;
+  }
+}
+
+void* counted_alloc(std::size_t size) {
+  count_alloc(size);
+  if (void* p = std::malloc(size == 0 ? 1 : size)) {
+    return p;
+  }
+  out_of_memory();
+}
+
+void* counted_alloc(std::size_t size, std::align_val_t align) {
+  count_alloc(size);
+  const auto alignment = static_cast<std::size_t>(align);
+  // std::aligned_alloc() wants the size to be a multiple of the alignment
+  const std::size_t rounded = (size + alignment - 1) / alignment * alignment;
+  if (void* p = std::aligned_alloc(alignment, rounded == 0 ? alignment : rounded)) {
+    return p;
+  }
+  out_of_memory();
+}
+
+void counted_free(void* p) noexcept {
+  count_free(p);
+  std::free(p);
+}
+} // namespace
+
+namespace bench {
+AllocStats alloc_stats() noexcept {
+  return {g_count.load(std::memory_order_relaxed), g_bytes.load(std::memory_order_relaxed),
+          g_frees.load(std::memory_order_relaxed)};
+}
+
+AllocStats thread_alloc_stats() noexcept { return t_stats; }
+
+NoAllocGuard::NoAllocGuard(const char* what, Mode mode) noexcept
+  : m_what(what), m_mode(mode), m_outer(t_guard), m_start(t_stats)
+{
+  t_guard = this;
+  t_failing += m_mode == Mode::Fail ? 1 : 0;
+}
+
+NoAllocGuard::~NoAllocGuard() {
+  t_guard = m_outer;
+  t_failing -= m_mode == Mode::Fail ? 1 : 0;
+}
+} // namespace bench
+
+void* operator new  (std::size_t size)                        { return counted_alloc(size); }
+void* operator new[](std::size_t size)                        { return counted_alloc(size); }
+void* operator new  (std::size_t size, std::align_val_t align) { return counted_alloc(size, align); }
+void* operator new[](std::size_t size, std::align_val_t align) { return counted_alloc(size, align); }
+
+void operator delete  (void* p) noexcept                               { counted_free(p); }
+void operator delete[](void* p) noexcept                               { counted_free(p); }
+void operator delete  (void* p, std::size_t) noexcept                  { counted_free(p); }
+void operator delete[](void* p, std::size_t) noexcept                  { counted_free(p); }
+void operator delete  (void* p, std::align_val_t) noexcept             { counted_free(p); }
+void operator delete[](void* p, std::align_val_t) noexcept             { counted_free(p); }
+void operator delete  (void* p, std::size_t, std::align_val_t) noexcept { counted_free(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { counted_free(p); }
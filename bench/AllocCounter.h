@@ -0,0 +1,60 @@
+#pragma once
+
+// Counts heap allocations made through the global `operator new`, and frees made through
+// `operator delete`, which AllocCounter.cpp replaces, for all threads and for each one.
+// Link AllocCounter.cpp into every benchmark executable.
+
+#include <cstddef>
+
+namespace bench {
+struct AllocStats {
+  std::size_t count = 0; // number of calls to `operator new`
+  std::size_t bytes = 0; // total bytes requested
+  std::size_t frees = 0; // number of calls to `operator delete` with a non-null pointer
+};
+
+// Allocations made by all threads since the program started.
+[[nodiscard]] AllocStats alloc_stats() noexcept;
+// Allocations made by the calling thread since it started.
+[[nodiscard]] AllocStats thread_alloc_stats() noexcept;
+
+// Allocations made between construction and `elapsed()`.
+class AllocScope {
+public:
+  AllocScope() noexcept : m_start(alloc_stats()) {}
+  [[nodiscard]] AllocStats elapsed() const noexcept {
+    const AllocStats now = alloc_stats();
+    return {now.count - m_start.count, now.bytes - m_start.bytes, now.frees - m_start.frees};
+  }
+private:
+  AllocStats m_start;
+};
+
+// Checks that the calling thread doesn't allocate while the guard is alive, as in the
+// steady state of a hot path. In `Fail` mode, an allocation prints `what` and aborts,
+// right in `operator new`, so that a debugger or a core dump shows who allocated; in
+// `Count` mode, allocations are only counted, for `allocations()` to report. Guards
+// nest; an allocation fails if any of the calling thread's guards is in `Fail` mode.
+class NoAllocGuard {
+public:
+  enum class Mode { Fail, Count };
+
+  explicit NoAllocGuard(const char* what, Mode mode = Mode::Fail) noexcept;
+  ~NoAllocGuard();
+  NoAllocGuard(const NoAllocGuard&)            = delete;
+  NoAllocGuard& operator=(const NoAllocGuard&) = delete;
+
+  // Allocations made by the calling thread since the guard was constructed
+  [[nodiscard]] AllocStats allocations() const noexcept {
+    const AllocStats now = thread_alloc_stats();
+    return {now.count - m_start.count, now.bytes - m_start.bytes, now.frees - m_start.frees};
+  }
+  [[nodiscard]] const char* what() const noexcept { return m_what; }
+
+private:
+  const char*   m_what;
+  Mode          m_mode;
+  NoAllocGuard* m_outer;
+  AllocStats    m_start;
+};
+} // namespace bench
@@ -0,0 +1,86 @@
+#pragma once
+
+// Tiny helpers shared by the benchmark executables.
+
+#include "AllocCounter.h"
+#include "Output.h"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+
+namespace bench {
+
+// Keeps the compiler from optimizing away the computation of `value`.
+template<typename T>
+inline void do_not_optimize(T&& value) {
+#if defined(_MSC_VER)
+  static const void* volatile sink;
+  sink = &value;
+#else
+  asm volatile("" : : "g"(&value) : "memory");
+#endif
+}
+
+struct Result {
+  double      ns_per_op     = 0.0;
+  double      allocs_per_op = 0.0;
+  double      bytes_per_op  = 0.0;
+};
+
+// Calls `op()` `iterations` times and returns the average cost of a call.
+template<typename Op>
+Result measure(std::size_t iterations, Op&& op) {
+  const AllocScope allocs;
+  const auto start = std::chrono::steady_clock::now();
+  for (std::size_t i = 0; i < iterations; ++i) {
+    op();
+  }
+  const auto stop = std::chrono::steady_clock::now();
+  const AllocStats a = allocs.elapsed();
+  const auto n = static_cast<double>(iterations);
+  return {std::chrono::duration<double, std::nano>(stop - start).count() / n,
+          static_cast<double>(a.count) / n,
+          static_cast<double>(a.bytes) / n};
+}
+
+// For the benchmarks that also check what they measure (which ctest runs): exits with
+// an error, saying `what` went wrong, unless `ok`.
+inline void check(bool ok, const char* what) {
+  if (!ok) {
+    std::fprintf(stderr, "check failed: %s\n", what);
+    std::exit(EXIT_FAILURE);
+  }
+}
+
+inline void report(const char* name, const Result& r) {
+  std::printf("%-52s %10.2f ns/op %8.2f allocs/op %10.1f bytes/op\n",
+              name, r.ns_per_op, r.allocs_per_op, r.bytes_per_op);
+}
+
+// Discards the records of `Office::work()` and everything written to std::cout while
+// alive, so that benchmarks measure the dispatch rather than the terminal.
+class SilenceCout {
+public:
+  SilenceCout() {
+    std::cout.setstate(std::ios_base::badbit);
+    Library::set_output(m_sink, Library::FlushPolicy::size(64 * 1024));
+  }
+  ~SilenceCout() {
+    Library::reset_output();
+    std::cout.clear();
+  }
+  SilenceCout(const SilenceCout&)            = delete;
+  SilenceCout& operator=(const SilenceCout&) = delete;
+
+private:
+  class NullSink final : public Library::OutputSink {
+  protected:
+    void write(std::string_view) override {}
+  };
+  NullSink m_sink;
+};
+
+} // namespace bench
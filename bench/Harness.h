@@ -0,0 +1,305 @@
+#pragma once
+
+// A minimal in-tree harness in the style of Google Benchmark, for benchmarks made of many
+// cases. Each case is a function taking a `bench::State&`, registered with `BENCHMARK()`
+// or `bench::register_benchmark()`, that times its loop `for (auto _ : state) { ... }`:
+//
+//   void work_on_nothing(bench::State& state) {
+//     Library::Office office{Programmer{"Peter"}};
+//     for (auto _ : state) {
+//       office.work(Monitor{}, Keyboard{}, Cup{});
+//     }
+//   }
+//   BENCHMARK(work_on_nothing);
+//   int main(int argc, char* argv[]) { return bench::run_benchmarks(argc, argv); }
+//
+// The harness picks the number of iterations of each case so that its loop runs for
+// `--benchmark_min_time` seconds at least, and writes the results as JSON, to stdout or
+// to the file given with `--benchmark_out`, with a line per case on stderr as it goes.
+// `--benchmark_filter=<regex>` runs only the cases whose names match.
+// Where Linux lets the process read hardware performance counters, the results include
+// cycles, instructions, branch misses, and L1 data and last-level cache read misses per
+// iteration (see PerfCounters.h); `--benchmark_perf_counters=false` leaves them out.
+
+#include "Bench.h"
+#include "PerfCounters.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <functional>
+#include <regex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace bench {
+
+class State {
+public:
+  explicit State(std::size_t iterations, PerfCounters* counters = nullptr) noexcept
+    : m_iterations(iterations), m_counters(counters) {}
+  State(const State&)            = delete;
+  State& operator=(const State&) = delete;
+
+  // Has a constructor and a destructor of its own, so that compilers don't warn about an unused `_`
+  struct Value {
+    Value() noexcept {}
+    ~Value() {}
+  };
+
+  class Iterator {
+  public:
+    Iterator(State* state, std::size_t left) noexcept : m_state(state), m_left(left) {}
+    Value operator*() const noexcept { return {}; }
+    Iterator& operator++() noexcept {
+      --m_left;
+      return *this;
+    }
+    // Stops the clock when the last iteration is done.
+    bool operator!=(const Iterator&) noexcept {
+      if (m_left != 0) {
+        return true;
+      }
+      m_state->stop();
+      return false;
+    }
+  private:
+    State*      m_state;
+    std::size_t m_left;
+  };
+
+  // Starts the clock.
+  Iterator begin() noexcept {
+    m_allocs = AllocScope();
+    if (m_counters != nullptr) {
+      m_counters->start();
+    }
+    m_start = std::chrono::steady_clock::now();
+    return {this, m_iterations};
+  }
+  Iterator end() noexcept { return {this, 0}; }
+
+  [[nodiscard]] std::size_t iterations() const noexcept { return m_iterations; }
+
+  // Reported along with the results, to tell how a case measures what it does
+  void set_label(std::string label) { m_label = std::move(label); }
+
+  [[nodiscard]] const std::string& label() const noexcept { return m_label; }
+  [[nodiscard]] double seconds() const noexcept { return m_seconds; }
+  [[nodiscard]] const AllocStats& allocs() const noexcept { return m_alloc_stats; }
+  [[nodiscard]] const PerfCounters::Values& counters() const noexcept { return m_counter_values; }
+
+private:
+  void stop() noexcept {
+    const auto stop = std::chrono::steady_clock::now();
+    if (m_counters != nullptr) {
+      m_counter_values = m_counters->stop();
+    }
+    m_alloc_stats = m_allocs.elapsed();
+    m_seconds     = std::chrono::duration<double>(stop - m_start).count();
+  }
+
+  std::size_t                           m_iterations;
+  PerfCounters*                         m_counters;
+  PerfCounters::Values                  m_counter_values;
+  std::chrono::steady_clock::time_point m_start;
+  AllocScope                            m_allocs;
+  AllocStats                            m_alloc_stats;
+  double                                m_seconds = 0.0;
+  std::string                           m_label;
+};
+
+struct Benchmark {
+  std::string                 name;
+  std::function<void(State&)> function;
+};
+
+inline std::vector<Benchmark>& benchmarks() {
+  static std::vector<Benchmark> registered;
+  return registered;
+}
+
+inline int register_benchmark(std::string name, std::function<void(State&)> function) {
+  benchmarks().push_back({std::move(name), std::move(function)});
+  return 0;
+}
+
+#define BENCH_CONCAT_IMPL(a, b) a##b
+#define BENCH_CONCAT(a, b) BENCH_CONCAT_IMPL(a, b)
+#define BENCHMARK(function) \
+  [[maybe_unused]] static const int BENCH_CONCAT(bench_registered_, __LINE__) = ::bench::register_benchmark(#function, function)
+
+namespace detail {
+
+struct Options {
+  double      min_time = 0.1; // seconds
+  std::regex  filter{".*"};
+  std::string out;            // stdout if empty
+  bool        perf_counters = true;
+};
+
+inline bool parse_option(std::string_view argument, std::string_view name, std::string& value) {
+  if (argument.size() > name.size() && argument.substr(0, name.size()) == name && argument[name.size()] == '=') {
+    value = std::string(argument.substr(name.size() + 1));
+    return true;
+  }
+  return false;
+}
+
+inline void append_json_string(std::string& json, std::string_view text) {
+  json += '"';
+  for (const char c : text) {
+    if (c == '"' || c == '\\') {
+      json += '\\';
+    }
+    json += c;
+  }
+  json += '"';
+}
+
+struct CaseResult {
+  std::string name;
+  std::string label;
+  std::size_t          iterations = 0;
+  Result               result;
+  PerfCounters::Values counters; // per iteration
+};
+
+// Runs `benchmark` with more and more iterations until they take `min_time`.
+inline CaseResult run_case(const Benchmark& benchmark, double min_time, PerfCounters& counters) {
+  constexpr std::size_t kMaxIterations = 1'000'000'000;
+  std::size_t iterations = 1;
+  for (;;) {
+    State state(iterations, &counters);
+    benchmark.function(state);
+    if (state.seconds() >= min_time || iterations >= kMaxIterations) {
+      const auto n = static_cast<double>(iterations);
+      CaseResult result{benchmark.name, state.label(), iterations,
+                        {state.seconds() * 1e9 / n, static_cast<double>(state.allocs().count) / n,
+                         static_cast<double>(state.allocs().bytes) / n}, {}};
+      for (std::size_t i = 0; i < PerfCounters::kCounterCount; ++i) {
+        if (state.counters()[i]) {
+          result.counters[i] = *state.counters()[i] / n;
+        }
+      }
+      return result;
+    }
+    // Aim a little past `min_time`, growing at most 10 times per run.
+    const double factor = std::clamp(min_time * 1.4 / std::max(state.seconds(), 1e-9), 2.0, 10.0);
+    iterations = std::min(kMaxIterations, static_cast<std::size_t>(static_cast<double>(iterations) * factor));
+  }
+}
+
+inline std::string to_json(const std::vector<CaseResult>& results, const PerfCounters& counters) {
+  char date[32];
+  const std::time_t now = std::time(nullptr);
+  std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+  std::string json = "{\n  \"context\": {\n    \"date\": ";
+  append_json_string(json, date);
+  json += ",\n    \"num_cpus\": " + std::to_string(std::thread::hardware_concurrency());
+#ifdef NDEBUG
+  json += ",\n    \"library_build_type\": \"release\"";
+#else
+  json += ",\n    \"library_build_type\": \"debug\"";
+#endif
+  json += ",\n    \"perf_counters\": [";
+  for (std::size_t i = 0, listed = 0; i < PerfCounters::kCounterCount; ++i) {
+    if (counters.available(static_cast<PerfCounters::Counter>(i))) {
+      json += listed++ == 0 ? "" : ", ";
+      append_json_string(json, PerfCounters::kNames[i]);
+    }
+  }
+  json += "]";
+  if (!counters.error().empty()) {
+    json += ",\n    \"perf_counters_error\": ";
+    append_json_string(json, counters.error());
+  }
+  json += "\n  },\n";
+  json += "  \"benchmarks\": [";
+  for (std::size_t i = 0; i < results.size(); ++i) {
+    const CaseResult& r = results[i];
+    char numbers[256];
+    std::snprintf(numbers, sizeof(numbers),
+                  ",\n      \"iterations\": %zu,\n      \"real_time\": %.3f,\n      \"time_unit\": \"ns\","
+                  "\n      \"ns_per_op\": %.3f,\n      \"allocs_per_op\": %.4f,\n      \"bytes_per_op\": %.2f",
+                  r.iterations, r.result.ns_per_op, r.result.ns_per_op, r.result.allocs_per_op, r.result.bytes_per_op);
+    json += i == 0 ? "\n    {\n      \"name\": " : ",\n    {\n      \"name\": ";
+    append_json_string(json, r.name);
+    json += numbers;
+    for (std::size_t c = 0; c < PerfCounters::kCounterCount; ++c) {
+      if (r.counters[c]) {
+        std::snprintf(numbers, sizeof(numbers), ",\n      \"%s_per_op\": %.3f", PerfCounters::kNames[c], *r.counters[c]);
+        json += numbers;
+      }
+    }
+    if (!r.label.empty()) {
+      json += ",\n      \"label\": ";
+      append_json_string(json, r.label);
+    }
+    json += "\n    }";
+  }
+  json += "\n  ]\n}\n";
+  return json;
+}
+
+} // namespace detail
+
+// Runs the registered benchmarks, as the command line says, and returns the exit status.
+inline int run_benchmarks(int argc, char* argv[]) {
+  detail::Options options;
+  for (int i = 1; i < argc; ++i) {
+    const std::string_view argument = argv[i];
+    std::string value;
+    if (detail::parse_option(argument, "--benchmark_min_time", value)) {
+      options.min_time = std::atof(value.c_str());
+    } else if (detail::parse_option(argument, "--benchmark_filter", value)) {
+      options.filter = std::regex(value);
+    } else if (detail::parse_option(argument, "--benchmark_out", value)) {
+      options.out = value;
+    } else if (detail::parse_option(argument, "--benchmark_perf_counters", value)) {
+      options.perf_counters = value != "false" && value != "0";
+    } else {
+      std::fprintf(stderr, "usage: %s [--benchmark_filter=<regex>] [--benchmark_min_time=<seconds>] "
+                           "[--benchmark_out=<file.json>] [--benchmark_perf_counters=false]\n", argv[0]);
+      return EXIT_FAILURE;
+    }
+  }
+
+  PerfCounters counters(options.perf_counters);
+  if (options.perf_counters && !counters.any_available()) {
+    std::fprintf(stderr, "no performance counters (%s): timing only\n", counters.error().c_str());
+  }
+  std::vector<detail::CaseResult> results;
+  for (const Benchmark& benchmark : benchmarks()) {
+    if (std::regex_search(benchmark.name, options.filter)) {
+      results.push_back(detail::run_case(benchmark, options.min_time, counters));
+      const detail::CaseResult& r = results.back();
+      std::fprintf(stderr, "%-44s %10.2f ns/op %8.2f allocs/op %10.1f bytes/op %12zu iterations",
+                   r.name.c_str(), r.result.ns_per_op, r.result.allocs_per_op, r.result.bytes_per_op, r.iterations);
+      if (r.counters[PerfCounters::Cycles] && r.counters[PerfCounters::Instructions]) {
+        std::fprintf(stderr, " %8.1f cycles/op %8.1f instructions/op", *r.counters[PerfCounters::Cycles],
+                     *r.counters[PerfCounters::Instructions]);
+      }
+      std::fputc('\n', stderr);
+    }
+  }
+
+  const std::string json = detail::to_json(results, counters);
+  std::FILE* file = options.out.empty() ? stdout : std::fopen(options.out.c_str(), "w");
+  if (file == nullptr) {
+    std::fprintf(stderr, "can't write %s\n", options.out.c_str());
+    return EXIT_FAILURE;
+  }
+  std::fputs(json.c_str(), file);
+  if (file != stdout) {
+    std::fclose(file);
+  }
+  return EXIT_SUCCESS;
+}
+
+} // namespace bench
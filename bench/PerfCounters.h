@@ -0,0 +1,137 @@
+#pragma once
+
+// Hardware performance counters of the calling thread, read with Linux
+// `perf_event_open()`. Each counter is opened on its own, so that those the CPU or the
+// kernel won't count (in a container or a VM, or with a strict `perf_event_paranoid`)
+// are just missing; elsewhere than on Linux, they all are.
+
+#include <array>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <string>
+#include <utility>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace bench {
+
+class PerfCounters {
+public:
+  enum Counter { Cycles, Instructions, BranchMisses, L1dMisses, LlcMisses, kCounterCount };
+  static constexpr std::array<const char*, kCounterCount> kNames{
+    "cycles", "instructions", "branch_misses", "l1d_misses", "llc_misses",
+  };
+
+  // The count of each counter between `start()` and `stop()`, if it's available
+  using Values = std::array<std::optional<double>, kCounterCount>;
+
+  // Opens the counters, unless `enabled` is false.
+  explicit PerfCounters(bool enabled = true) {
+    m_fds.fill(-1);
+#if defined(__linux__)
+    if (!enabled) {
+      m_error = "disabled";
+      return;
+    }
+    constexpr auto cache_read_miss = [](std::uint64_t cache) {
+      return cache | (std::uint64_t{PERF_COUNT_HW_CACHE_OP_READ} << 8) | (std::uint64_t{PERF_COUNT_HW_CACHE_RESULT_MISS} << 16);
+    };
+    const std::array<std::pair<std::uint32_t, std::uint64_t>, kCounterCount> events{{
+      {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+      {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+      {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+      {PERF_TYPE_HW_CACHE, cache_read_miss(PERF_COUNT_HW_CACHE_L1D)},
+      {PERF_TYPE_HW_CACHE, cache_read_miss(PERF_COUNT_HW_CACHE_LL)},
+    }};
+    for (std::size_t i = 0; i < kCounterCount; ++i) {
+      perf_event_attr attr;
+      std::memset(&attr, 0, sizeof(attr));
+      attr.size           = sizeof(attr);
+      attr.type           = events[i].first;
+      attr.config         = events[i].second;
+      attr.disabled       = 1;
+      attr.exclude_kernel = 1; // allowed with the default perf_event_paranoid
+      attr.exclude_hv     = 1;
+      attr.read_format    = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+      m_fds[i] = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+      if (m_fds[i] < 0 && m_error.empty()) {
+        m_error = std::string("perf_event_open: ") + std::strerror(errno);
+      }
+    }
+#else
+    static_cast<void>(enabled);
+    m_error = "only available on Linux";
+#endif
+  }
+  ~PerfCounters() {
+#if defined(__linux__)
+    for (const int fd : m_fds) {
+      if (fd >= 0) {
+        close(fd);
+      }
+    }
+#endif
+  }
+  PerfCounters(const PerfCounters&)            = delete;
+  PerfCounters& operator=(const PerfCounters&) = delete;
+
+  [[nodiscard]] bool available(Counter counter) const noexcept { return m_fds[counter] >= 0; }
+  [[nodiscard]] bool any_available() const noexcept {
+    for (const int fd : m_fds) {
+      if (fd >= 0) {
+        return true;
+      }
+    }
+    return false;
+  }
+  // Why the first counter that isn't available isn't
+  [[nodiscard]] const std::string& error() const noexcept { return m_error; }
+
+  void start() noexcept {
+#if defined(__linux__)
+    for (const int fd : m_fds) {
+      if (fd >= 0) {
+        ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+      }
+    }
+#endif
+  }
+
+  // Counts scaled up for the time a counter wasn't scheduled, when there are more
+  // counters than the CPU has registers for.
+  [[nodiscard]] Values stop() noexcept {
+    Values values;
+#if defined(__linux__)
+    for (const int fd : m_fds) {
+      if (fd >= 0) {
+        ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+      }
+    }
+    for (std::size_t i = 0; i < kCounterCount; ++i) {
+      struct {
+        std::uint64_t value, enabled, running;
+      } read_values{};
+      if (m_fds[i] >= 0 && read(m_fds[i], &read_values, sizeof(read_values)) == sizeof(read_values)
+          && read_values.running > 0) {
+        values[i] = static_cast<double>(read_values.value) * static_cast<double>(read_values.enabled)
+                    / static_cast<double>(read_values.running);
+      }
+    }
+#endif
+    return values;
+  }
+
+private:
+  std::array<int, kCounterCount> m_fds;
+  std::string                    m_error;
+};
+
+} // namespace bench
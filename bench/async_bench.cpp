@@ -0,0 +1,69 @@
+// Measures the per-call overhead of fanning `Programmer` work out asynchronously and
+// waiting for all of it: `Office::work_async()` on an `Executor`, against the same
+// executor completing a `std::promise`, and against `std::async()`, which starts a
+// thread per call.
+
+#include "Bench.h"
+#include "Persons.h"
+
+#include <future>
+#include <vector>
+
+int main() {
+  constexpr std::size_t kCalls      = 100'000;
+  constexpr std::size_t kAsyncCalls = 2'000; // std::async starts a thread per call
+  const bench::SilenceCout silence;
+  Library::Office office{Programmer{"Peter"}};
+  Library::Executor executor;
+
+  std::vector<Library::WorkFuture> futures;
+  futures.reserve(kCalls);
+  const auto work_async = [&] {
+    for (std::size_t i = 0; i < kCalls; ++i) {
+      futures.push_back(office.work_async(executor, Monitor{}, Keyboard{}, Cup{}));
+    }
+    for (const Library::WorkFuture& future : futures) {
+      future.wait();
+    }
+    futures.clear();
+  };
+  work_async(); // warms up the block pools
+  const bench::Result pooled = bench::measure(1, work_async);
+
+  std::vector<std::future<void>> std_futures;
+  std_futures.reserve(kCalls);
+  const bench::Result promise = bench::measure(1, [&] {
+    for (std::size_t i = 0; i < kCalls; ++i) {
+      std::promise<void> done;
+      std_futures.push_back(done.get_future());
+      executor.submit([&office, done = std::move(done)]() mutable {
+        office.work(Monitor{}, Keyboard{}, Cup{});
+        done.set_value();
+      });
+    }
+    for (const std::future<void>& future : std_futures) {
+      future.wait();
+    }
+    std_futures.clear();
+  });
+
+  const bench::Result async = bench::measure(1, [&] {
+    for (std::size_t i = 0; i < kAsyncCalls; ++i) {
+      std_futures.push_back(std::async(std::launch::async, [&office] {
+        office.work(Monitor{}, Keyboard{}, Cup{});
+      }));
+    }
+    for (const std::future<void>& future : std_futures) {
+      future.wait();
+    }
+    std_futures.clear();
+  });
+
+  const auto per_call = [](const bench::Result& r, std::size_t calls) {
+    const auto n = static_cast<double>(calls);
+    return bench::Result{r.ns_per_op / n, r.allocs_per_op / n, r.bytes_per_op / n};
+  };
+  bench::report("Office::work_async() per call", per_call(pooled, kCalls));
+  bench::report("Executor::submit() + std::promise per call", per_call(promise, kCalls));
+  bench::report("std::async() per call", per_call(async, kAsyncCalls));
+}
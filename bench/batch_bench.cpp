@@ -0,0 +1,30 @@
+// Measures the throughput of `Office::work_batch()`, which crosses the type erasure
+// once per batch, against calling `Office::work()` for each item.
+
+#include "Bench.h"
+#include "Persons.h"
+
+#include <span>
+#include <tuple>
+
+int main() {
+  constexpr std::size_t kItemsPerRun = 1 << 20;
+  const bench::SilenceCout silence;
+  Library::Office office{Programmer{"Peter"}};
+
+  const auto per_item = bench::measure(kItemsPerRun, [&] {
+    office.work(Monitor{}, Keyboard{}, Cup{});
+  });
+  bench::report("work() per item", per_item);
+  std::printf("  %.1f M items/s\n", 1e3 / per_item.ns_per_op);
+
+  for (const std::size_t batch_size : {1u, 16u, 256u, 4096u}) {
+    const std::vector<std::tuple<Monitor, Keyboard, Cup>> items(batch_size);
+    const auto batch = bench::measure(kItemsPerRun / batch_size, [&] {
+      office.work_batch(std::span(items));
+    });
+    const std::string name = "work_batch() of " + std::to_string(batch_size);
+    bench::report(name.c_str(), batch);
+    std::printf("  %.1f M items/s\n", 1e3 * static_cast<double>(batch_size) / batch.ns_per_op);
+  }
+}
@@ -0,0 +1,165 @@
+// Measures the cost per record of `Office::work()` writing 10M records ("Peter is working
+// on keyboard, monitor, and coffee") to a file, formatted through `std::ostream` by the
+// calling thread (with `FlushPolicy::size(64 KiB)`), versus stored in binary form while a
+// `Library::BinaryLog` is active. For the latter, "calling thread" is the time spent in
+// `work()`, measured in blocks of calls small enough for the ring, between which the
+// log renders the records (so that it doesn't compete for the CPU, even with a single
+// core), and "total" is the time to write and render all the records in one go.
+// Then checks that records of more than half the ring, which may not fit wherever its
+// tail is, are rendered rather than waited for forever, and in order.
+//
+// Usage: binary_log_bench [file [calls]]; the file (binary_log_bench.txt by default) is
+// removed.
+
+#include "BinaryLog.h"
+#include "Bench.h"
+#include "Persons.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+
+namespace {
+
+long file_size(const char* path) {
+  std::FILE* file = std::fopen(path, "rb");
+  std::fseek(file, 0, SEEK_END);
+  const long bytes = std::ftell(file);
+  std::fclose(file);
+  return bytes;
+}
+
+// Counts the bytes written
+class CountingSink final : public Library::OutputSink {
+public:
+  std::size_t bytes = 0;
+
+protected:
+  void write(std::string_view records) override { bytes += records.size(); }
+};
+
+// Keeps the first character of each line committed, in order
+class FirstCharSink final : public Library::OutputSink {
+public:
+  std::string firsts;
+
+protected:
+  void write(std::string_view records) override {
+    for (std::size_t start = 0; start < records.size(); start = records.find('\n', start) + 1) {
+      firsts.push_back(records[start]);
+    }
+  }
+};
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+  const char* path = argc > 1 ? argv[1] : "binary_log_bench.txt";
+  const std::size_t calls = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 10'000'000;
+  Library::Office office{Programmer{"Peter"}};
+
+  {
+    std::FILE* file = std::fopen(path, "wb");
+    Library::FileSink sink(file);
+    Library::set_output(sink, Library::FlushPolicy::size(64 * 1024));
+    const bench::Result r = bench::measure(calls, [&] { office.work(Monitor{}, Keyboard{}, Cup{}); });
+    Library::reset_output();
+    std::fclose(file);
+    bench::report("text, FlushPolicy::size(64 KiB)", r);
+    std::printf("  %.1f MB written\n", static_cast<double>(file_size(path)) / 1e6);
+  }
+
+  {
+    std::FILE* file = std::fopen(path, "wb");
+    Library::FileSink sink(file);
+    bench::Result calling;
+    bench::Result total;
+    {
+      Library::BinaryLog log(sink);
+      constexpr std::size_t kBlock = 4096;
+      for (std::size_t done = 0; done < calls; done += kBlock) {
+        const std::size_t block = std::min(kBlock, calls - done);
+        const bench::Result r = bench::measure(block, [&] { office.work(Monitor{}, Keyboard{}, Cup{}); });
+        const double share = static_cast<double>(block) / static_cast<double>(calls);
+        calling.ns_per_op += r.ns_per_op * share;
+        calling.allocs_per_op += r.allocs_per_op * share;
+        log.sync();
+      }
+      total = bench::measure(calls, [&] { office.work(Monitor{}, Keyboard{}, Cup{}); });
+      const auto start = std::chrono::steady_clock::now();
+      log.sync();
+      total.ns_per_op += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count()
+                         / static_cast<double>(calls);
+    }
+    std::fclose(file);
+    bench::report("BinaryLog, calling thread", calling);
+    bench::report("BinaryLog, total", total);
+    std::printf("  %.1f MB written\n", static_cast<double>(file_size(path)) / 1e6);
+  }
+  std::remove(path);
+
+  // In a new thread, whose ring (1 MiB) is new, the first record leaves its tail past
+  // the middle, where the second one needs more than the whole ring, even drained.
+  CountingSink sink;
+  {
+    Library::BinaryLog log(sink);
+    std::thread([&] {
+      for (const std::size_t size : {std::size_t{500'000}, std::size_t{600'000}}) {
+        const std::string text(size, 'x');
+        {
+          const Library::OutputRecord record;
+          Library::out() << text;
+        }
+        log.sync();
+      }
+    }).join();
+  }
+  bench::check(sink.bytes == 500'001 + 600'001, "oversized records weren't all written");
+
+  // An oversized record, rendered by its thread, comes after the records before it,
+  // even while the log, having drained those, still renders another thread's records
+  // before committing its batch.
+  FirstCharSink order;
+  std::string expected;
+  {
+    Library::BinaryLog log(order);
+    std::atomic<int> stage{0}; // 1 once the writer's ring comes first, 2 when it's done
+    std::thread writer([&] {
+      {
+        const Library::OutputRecord record;
+        Library::out() << 'a';
+      }
+      expected += 'a';
+      stage = 1;
+      const std::string big(600'000, 'x');
+      for (int round = 0; round < 200; ++round) {
+        for (int i = 0; i < 100; ++i) {
+          const Library::OutputRecord record;
+          Library::out() << 'a';
+        }
+        const Library::OutputRecord record;
+        Library::out() << big;
+        expected += std::string(100, 'a') + 'x';
+      }
+      stage = 2;
+    });
+    std::thread([&] {
+      while (stage == 0) {
+        std::this_thread::yield();
+      }
+      while (stage == 1) {
+        const Library::OutputRecord record;
+        Library::out() << "busy thread writing records";
+      }
+    }).join();
+    writer.join();
+  }
+  std::erase(order.firsts, 'b');
+  bench::check(order.firsts == expected, "an oversized record overtook records before it");
+  std::printf("oversized records: ok\n");
+}
@@ -0,0 +1,150 @@
+// Measures the catalogs of interned names behind `Ingredient` and `Recipe`:
+//  - lookups of known names (and 1% of insertions of new ones) from 1 to N threads, against
+//    a `std::unordered_map` behind a `std::mutex` (`catalog_bench N`; by default N is the
+//    number of hardware threads, and at least 4);
+//  - the memory taken by 1M recipes of 8 ingredients, drawn from 1000 recipe names and 200
+//    ingredient names, as handles, against recipes that own their names.
+
+#include "Bench.h"
+#include "Items.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+// Each run uses a catalog of its own.
+template<unsigned N>
+struct RunKind;
+
+class LockedCatalog {
+public:
+  std::uint32_t intern(const std::string& name) {
+    const std::lock_guard<std::mutex> lock(m_mutex);
+    return m_ids.try_emplace(name, static_cast<std::uint32_t>(m_ids.size())).first->second;
+  }
+private:
+  std::mutex                                     m_mutex;
+  std::unordered_map<std::string, std::uint32_t> m_ids;
+};
+
+constexpr std::size_t kVocabulary    = 4096;
+constexpr std::size_t kOpsPerThread  = 1 << 20;
+constexpr std::size_t kInsertionRate = 100; // one in
+
+std::vector<std::string> make_names(const char* prefix, std::size_t count) {
+  std::vector<std::string> names;
+  for (std::size_t i = 0; i < count; ++i) {
+    names.push_back(prefix + std::to_string(i));
+  }
+  return names;
+}
+
+// Runs `intern(name)` from `threads` threads, and returns the wall time per operation.
+template<typename F>
+double run_threads(unsigned threads, const std::vector<std::string>& known, F&& intern) {
+  std::vector<std::thread> workers;
+  const auto start = std::chrono::steady_clock::now();
+  for (unsigned t = 0; t < threads; ++t) {
+    workers.emplace_back([&, t] {
+      std::string fresh = "new ingredient " + std::to_string(t) + "/";
+      const std::size_t prefix = fresh.size();
+      for (std::size_t i = 0; i < kOpsPerThread; ++i) {
+        if (i % kInsertionRate == 0) {
+          fresh.resize(prefix);
+          fresh += std::to_string(i);
+          bench::do_not_optimize(intern(fresh));
+        } else {
+          bench::do_not_optimize(intern(known[(i * 2654435761u + t) % known.size()]));
+        }
+      }
+    });
+  }
+  for (auto& worker : workers) {
+    worker.join();
+  }
+  const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+  return elapsed.count() / static_cast<double>(kOpsPerThread * threads);
+}
+
+template<unsigned N>
+void run_concurrency(unsigned threads, const std::vector<std::string>& known) {
+  using Name = Library::InternedName<RunKind<N>>;
+  for (const std::string& name : known) {
+    (void)Name(name); // the warm-up
+  }
+  const double interned_ns = run_threads(threads, known, [](const std::string& name) { return Name(name).id(); });
+  LockedCatalog locked;
+  for (const std::string& name : known) {
+    locked.intern(name);
+  }
+  const double locked_ns = run_threads(threads, known, [&](const std::string& name) { return locked.intern(name); });
+  std::printf("%2u threads: InternedName %8.2f ns/op, mutex + unordered_map %8.2f ns/op\n",
+              threads, interned_ns, locked_ns);
+}
+
+template<unsigned... Ns>
+void run_concurrency(unsigned max_threads, const std::vector<std::string>& known, std::integer_sequence<unsigned, Ns...>) {
+  ((max_threads >= (1u << Ns) ? run_concurrency<Ns>(1u << Ns, known) : void()), ...);
+}
+
+struct LegacyRecipe {
+  std::string              name;
+  std::vector<std::string> ingredients;
+};
+
+struct HandleRecipe {
+  Recipe                  recipe;
+  std::vector<Ingredient> ingredients;
+};
+
+constexpr std::size_t kRecipes     = 1'000'000;
+constexpr std::size_t kIngredients = 8;
+
+template<typename R, typename Make>
+void report_footprint(const char* name, Make&& make) {
+  const bench::AllocScope allocs;
+  std::vector<R> recipes;
+  recipes.reserve(kRecipes);
+  for (std::size_t i = 0; i < kRecipes; ++i) {
+    recipes.push_back(make(i));
+  }
+  const bench::AllocStats a = allocs.elapsed();
+  std::printf("%-40s %8.1f MB, %6.1f bytes/recipe, %6.2f allocs/recipe\n", name,
+              static_cast<double>(a.bytes) / 1e6, static_cast<double>(a.bytes) / kRecipes,
+              static_cast<double>(a.count) / kRecipes);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+  const unsigned max_threads = argc > 1 ? static_cast<unsigned>(std::atoi(argv[1]))
+                                        : std::max(std::thread::hardware_concurrency(), 4u);
+  run_concurrency(max_threads, make_names("ingredient no. ", kVocabulary), std::make_integer_sequence<unsigned, 7>());
+
+  const std::vector<std::string> recipe_names = make_names("grandmother's recipe no. ", 1000);
+  const std::vector<std::string> ingredient_names = make_names("organic ingredient no. ", 200);
+  std::printf("sizeof(Recipe) = %zu, sizeof(Ingredient) = %zu\n", sizeof(Recipe), sizeof(Ingredient));
+  report_footprint<LegacyRecipe>("1M recipes owning their names (before)", [&](std::size_t i) {
+    LegacyRecipe recipe{recipe_names[i % recipe_names.size()], {}};
+    recipe.ingredients.reserve(kIngredients);
+    for (std::size_t j = 0; j < kIngredients; ++j) {
+      recipe.ingredients.push_back(ingredient_names[(i * 7 + j * 13) % ingredient_names.size()]);
+    }
+    return recipe;
+  });
+  report_footprint<HandleRecipe>("1M recipes of handles", [&](std::size_t i) {
+    HandleRecipe recipe{Recipe(recipe_names[i % recipe_names.size()]), {}};
+    recipe.ingredients.reserve(kIngredients);
+    for (std::size_t j = 0; j < kIngredients; ++j) {
+      recipe.ingredients.emplace_back(ingredient_names[(i * 7 + j * 13) % ingredient_names.size()]);
+    }
+    return recipe;
+  });
+}
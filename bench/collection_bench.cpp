@@ -0,0 +1,79 @@
+// Measures `AnyPersonCollection::for_each_work()`, which walks the persons segment by
+// segment of equal types, against calling `AnyPerson::work()` on each element of a
+// `std::vector<AnyPerson>` holding the same persons in random order, for 1M persons of
+// 2, 8 and 64 different types. Checks that `for_each_work()` has every person work,
+// with the right argument.
+
+#include "AnyPersonCollection.h"
+#include "Bench.h"
+
+#include <array>
+#include <random>
+
+namespace {
+
+std::size_t g_checksum = 0;
+
+template<std::size_t N>
+class Worker : public Library::Person {
+public:
+  using Library::Person::Person;
+  void do_work(std::size_t value) { g_checksum += value + N; }
+};
+
+constexpr std::size_t kMaxTypes = 64;
+
+struct Rosters {
+  Library::AnyPersonCollection collection;
+  std::vector<AnyPerson>       vector;
+  std::size_t                  checksum = 0; // of a call with `1` on each person
+};
+
+template<std::size_t N>
+void insert_worker(Rosters& rosters) {
+  rosters.collection.insert(Worker<N>{"w"});
+  rosters.vector.emplace_back(Worker<N>{"w"});
+  rosters.checksum += 1 + N;
+}
+
+template<std::size_t... Ns>
+constexpr auto make_inserters(std::index_sequence<Ns...>) {
+  return std::array<void (*)(Rosters&), sizeof...(Ns)>{{&insert_worker<Ns>...}};
+}
+
+} // namespace
+
+int main() {
+  constexpr std::size_t kPersons = 1'000'000;
+  constexpr auto inserters = make_inserters(std::make_index_sequence<kMaxTypes>());
+  const bench::SilenceCout silence;
+
+  for (const std::size_t types : {2u, 8u, 64u}) {
+    Rosters rosters;
+    rosters.vector.reserve(kPersons);
+    std::mt19937 random(42);
+    for (std::size_t i = 0; i < kPersons; ++i) {
+      inserters[random() % types](rosters);
+    }
+
+    g_checksum = 0;
+    bench::check(rosters.collection.for_each_work(std::size_t{1}) == kPersons && g_checksum == rosters.checksum,
+                 "for_each_work() missed persons or passed wrong arguments");
+
+    const auto per_person = [](const bench::Result& r) {
+      return bench::Result{r.ns_per_op / kPersons, r.allocs_per_op / kPersons, r.bytes_per_op / kPersons};
+    };
+    const std::string suffix = " (" + std::to_string(types) + " types), per person";
+    bench::report(("vector<AnyPerson>" + suffix).c_str(), per_person(bench::measure(5, [&] {
+      for (AnyPerson& person : rosters.vector) {
+        const Library::OutputRecord record;
+        Library::out() << person.name() << " is ";
+        person.work(std::size_t{1});
+      }
+    })));
+    bench::report(("AnyPersonCollection" + suffix).c_str(), per_person(bench::measure(5, [&] {
+      rosters.collection.for_each_work(std::size_t{1});
+    })));
+  }
+  bench::do_not_optimize(g_checksum);
+}
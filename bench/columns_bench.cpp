@@ -0,0 +1,47 @@
+// Measures `Office::work_columns()` over `Library::Columns` (structure of arrays) for a
+// person with `do_work_bulk()` (`Programmer`) and for one without it, against
+// `Office::work_batch()` over a span of tuples (array of structures).
+
+#include "Bench.h"
+#include "Persons.h"
+
+#include <span>
+#include <tuple>
+
+namespace {
+
+// `Programmer` without `do_work_bulk()`
+class PlainProgrammer : public Library::Person {
+public:
+  using Library::Person::Person;
+  void do_work(Monitor monitor, Keyboard keyboard, Cup coffee) {
+    Library::out() << keyboard.name() <<", "<< monitor.name() <<", and "<< coffee.name();
+  }
+};
+
+} // namespace
+
+int main() {
+  constexpr std::size_t kItemsPerRun = 1 << 20;
+  const bench::SilenceCout silence;
+  Library::Office bulk{Programmer{"Peter"}};
+  Library::Office plain{PlainProgrammer{"Paul"}};
+
+  for (const std::size_t batch_size : {16u, 256u, 4096u}) {
+    const std::size_t runs = kItemsPerRun / batch_size;
+    const std::vector<std::tuple<Monitor, Keyboard, Cup>> rows(batch_size);
+    Library::Columns<Monitor, Keyboard, Cup> columns;
+    for (std::size_t i = 0; i < batch_size; ++i) {
+      columns.push_back(Monitor{}, Keyboard{}, Cup{});
+    }
+
+    const auto report = [batch_size](const char* what, const bench::Result& r) {
+      const std::string name = std::string(what) + " of " + std::to_string(batch_size);
+      bench::report(name.c_str(), r);
+      std::printf("  %.1f M items/s\n", 1e3 * static_cast<double>(batch_size) / r.ns_per_op);
+    };
+    report("work_batch() rows", bench::measure(runs, [&] { plain.work_batch(std::span(rows)); }));
+    report("work_columns() per row", bench::measure(runs, [&] { plain.work_columns(columns); }));
+    report("work_columns() do_work_bulk", bench::measure(runs, [&] { bulk.work_columns(columns); }));
+  }
+}
@@ -0,0 +1,166 @@
+// Measures how many works, each of which waits 10 ms (for I/O, say), can be in flight
+// at once: 100k `do_work()` coroutines that `co_await` a timer, on a single thread,
+// against a `do_work()` that blocks its thread, on `Executor`s of 64 and 256 threads,
+// where each work in flight takes a thread. Also checks that a coroutine keeps its person
+// alive when the `Office` is a temporary, or is moved, while the work is in progress.
+
+#include "Bench.h"
+#include "Persons.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <coroutine>
+#include <queue>
+#include <set>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+constexpr std::chrono::milliseconds kWait{10};
+
+// Resumes the coroutines that `co_await sleep()` once their time has come, on the thread
+// calling `run()`.
+class Timers {
+public:
+  auto sleep(Clock::duration duration) {
+    struct Sleep {
+      Timers&           timers;
+      Clock::time_point deadline;
+      bool await_ready() const noexcept { return false; }
+      void await_suspend(std::coroutine_handle<> handle) { timers.m_queue.push({deadline, handle}); }
+      void await_resume() const noexcept {}
+    };
+    return Sleep{*this, Clock::now() + duration};
+  }
+
+  void run() {
+    while (!m_queue.empty()) {
+      const Entry next = m_queue.top();
+      std::this_thread::sleep_until(next.deadline);
+      m_queue.pop();
+      next.handle.resume();
+    }
+  }
+
+private:
+  struct Entry {
+    Clock::time_point       deadline;
+    std::coroutine_handle<> handle;
+    bool operator>(const Entry& other) const noexcept { return deadline > other.deadline; }
+  };
+  std::priority_queue<Entry, std::vector<Entry>, std::greater<>> m_queue;
+};
+
+struct Parcel {
+  std::size_t id = 0;
+};
+
+// Works started and not yet finished, and the most of them at any time
+std::atomic<std::size_t> g_in_flight{0};
+std::atomic<std::size_t> g_peak{0};
+
+void start_work() {
+  const std::size_t in_flight = g_in_flight.fetch_add(1) + 1;
+  std::size_t peak = g_peak.load();
+  while (peak < in_flight && !g_peak.compare_exchange_weak(peak, in_flight)) {}
+}
+void finish_work() { g_in_flight.fetch_sub(1); }
+
+class Courier : public Library::Person {
+public:
+  Courier(std::string name, Timers& timers) : Library::Person(std::move(name)), m_timers(&timers) {}
+  Library::WorkTask do_work(Parcel) {
+    start_work();
+    co_await m_timers->sleep(kWait);
+    finish_work();
+  }
+private:
+  Timers* m_timers;
+};
+
+// The `Waiter`s that exist, and how many found themselves among them once resumed
+std::set<const void*> g_waiters;
+std::size_t           g_waiters_alive_when_resumed = 0;
+
+class Waiter : public Library::Person {
+public:
+  Waiter(std::string name, Timers& timers) : Library::Person(std::move(name)), m_timers(&timers) { g_waiters.insert(this); }
+  Waiter(Waiter&& other) noexcept : Library::Person(std::move(other)), m_timers(other.m_timers) { g_waiters.insert(this); }
+  Waiter& operator=(Waiter&&) = delete;
+  ~Waiter() { g_waiters.erase(this); }
+
+  Library::WorkTask do_work(Parcel) {
+    co_await m_timers->sleep(std::chrono::milliseconds(1));
+    g_waiters_alive_when_resumed += g_waiters.count(this);
+  }
+private:
+  Timers* m_timers;
+};
+
+class BlockingCourier : public Library::Person {
+public:
+  using Library::Person::Person;
+  void do_work(Parcel) {
+    start_work();
+    std::this_thread::sleep_for(kWait);
+    finish_work();
+  }
+};
+
+void report(const char* name, unsigned threads, std::size_t works, Clock::duration elapsed) {
+  std::printf("%s, %u threads: %zu works in %.0f ms, at most %zu in flight (%.0f per thread)\n",
+              name, threads, works, std::chrono::duration<double, std::milli>(elapsed).count(),
+              g_peak.load(), static_cast<double>(g_peak.load()) / threads);
+  g_peak = 0;
+}
+
+} // namespace
+
+int main() {
+  constexpr std::size_t kWorks = 100'000;
+  const bench::SilenceCout silence;
+
+  Timers timers;
+  {
+    const Library::WorkTask from_temporary = Library::Office{Waiter{"Wanda", timers}}.work(Parcel{});
+    Library::Office office{Waiter{"Walt", timers}};
+    const Library::WorkTask from_moved = office.work(Parcel{});
+    const Library::Office moved = std::move(office);
+    timers.run();
+    bench::check(from_temporary.ready() && from_moved.ready() && g_waiters_alive_when_resumed == 2,
+                 "a coroutine keeps its person alive");
+  }
+  bench::check(g_waiters.empty(), "the person of a finished coroutine is destroyed with its Office");
+
+  Library::Office courier{Courier{"Carol", timers}};
+  std::vector<Library::WorkTask> tasks;
+  tasks.reserve(kWorks);
+  for (int round = 0; round < 2; ++round) { // the first round warms up the frame pool
+    const bench::AllocScope allocs;
+    const auto start = Clock::now();
+    for (std::size_t i = 0; i < kWorks; ++i) {
+      tasks.push_back(courier.work(Parcel{i}));
+    }
+    timers.run();
+    const auto elapsed = Clock::now() - start;
+    const bench::AllocStats a = allocs.elapsed();
+    tasks.clear();
+    report(round == 0 ? "coroutine do_work() (cold)" : "coroutine do_work()", 1, kWorks, elapsed);
+    std::printf("  %.2f allocs/work\n", static_cast<double>(a.count) / static_cast<double>(kWorks));
+  }
+
+  Library::Office blocking{BlockingCourier{"Bob"}};
+  for (const unsigned threads : {64u, 256u}) {
+    Library::Executor executor(threads);
+    const std::size_t works = 8 * threads;
+    const auto start = Clock::now();
+    for (std::size_t i = 0; i < works; ++i) {
+      blocking.submit_work(executor, Parcel{i});
+    }
+    executor.wait_idle();
+    report("blocking do_work()", threads, works, Clock::now() - start);
+  }
+}
@@ -0,0 +1,159 @@
+// Measures what calling `do_work()` through the type erasure costs, against the usual
+// alternatives, for 0 to 8 arguments that are all either `Small` (8 bytes, taken by value
+// and passed in a `detail::PackedFrame`) or `Large` (256 bytes, taken by const reference
+// and passed in a `detail::ArgRefFrame`):
+//  - `direct`: `do_work()` called on the concrete person;
+//  - `virtual`: through an interface with a virtual `do_work()`;
+//  - `function`: through a `std::function` wrapping the person;
+//  - `variant`: `std::visit()` on a `std::variant` of the person and another type;
+//  - `AnyPerson`: `AnyPerson::work()`, which also writes "working on " to the record;
+//  - `Office`: `Office::work()`, which also writes the person's name and commits the record
+//    (to a sink that discards it).
+// Writes the results as JSON; see Harness.h for the options.
+
+#include "Harness.h"
+#include "Persons.h"
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <variant>
+
+namespace {
+
+struct Small {
+  std::uint64_t value = 1;
+};
+struct Large {
+  std::array<std::uint64_t, 32> values{1};
+};
+
+std::uint64_t first_word(const Small& small) noexcept { return small.value; }
+std::uint64_t first_word(const Large& large) noexcept { return large.values[0]; }
+
+// How `do_work()` takes an argument of type `T`
+template<typename T>
+using Param = std::conditional_t<sizeof(T) <= sizeof(std::uint64_t), T, const T&>;
+
+template<typename T, std::size_t>
+using Repeat = T;
+
+template<typename... Args>
+struct IWorker {
+  virtual ~IWorker() = default;
+  virtual void do_work(Param<Args>... arguments) = 0;
+};
+
+template<typename... Args>
+class Summer final : public Library::Person, public IWorker<Args...> {
+public:
+  using Library::Person::Person;
+  void do_work(Param<Args>... arguments) override { m_sum += (std::uint64_t{0} + ... + first_word(arguments)); }
+private:
+  std::uint64_t m_sum = 0;
+};
+
+// The other alternative of the `std::variant`, so that `std::visit()` has a choice to make
+template<typename... Args>
+struct Idler {
+  void do_work(Param<Args>...) {}
+};
+
+template<typename T, std::size_t N, typename F>
+void run_with_arguments(bench::State& state, F&& call) {
+  // Const, so that `work()` may pack small arguments as it would pack temporaries
+  const auto arguments = []<std::size_t... Is>(std::index_sequence<Is...>) {
+    return std::tuple<Repeat<T, Is>...>();
+  }(std::make_index_sequence<N>());
+  for (auto _ : state) {
+    std::apply(call, arguments);
+  }
+}
+
+template<typename T, std::size_t N>
+struct Cases {
+  template<typename S>
+  struct Of;
+  template<std::size_t... Is>
+  struct Of<std::index_sequence<Is...>> {
+    using Person = Summer<Repeat<T, Is>...>;
+    using Worker = IWorker<Repeat<T, Is>...>;
+    using Variant = std::variant<Idler<Repeat<T, Is>...>, Person>;
+    using Function = std::function<void(Param<Repeat<T, Is>>...)>;
+  };
+  using Types = Of<std::make_index_sequence<N>>;
+
+  static void direct(bench::State& state) {
+    typename Types::Person person{"Peter"};
+    run_with_arguments<T, N>(state, [&](const auto&... arguments) {
+      person.do_work(arguments...);
+      bench::do_not_optimize(person);
+    });
+  }
+
+  static void virtual_call(bench::State& state) {
+    typename Types::Person person{"Peter"};
+    typename Types::Worker* worker = &person;
+    run_with_arguments<T, N>(state, [&](const auto&... arguments) {
+      bench::do_not_optimize(worker); // so that the call isn't devirtualized
+      worker->do_work(arguments...);
+    });
+  }
+
+  static void function(bench::State& state) {
+    typename Types::Person person{"Peter"};
+    typename Types::Function call = [&person](auto&&... arguments) { person.do_work(arguments...); };
+    run_with_arguments<T, N>(state, [&](const auto&... arguments) {
+      bench::do_not_optimize(call);
+      call(arguments...);
+    });
+  }
+
+  static void variant(bench::State& state) {
+    typename Types::Variant person{std::in_place_index<1>, "Peter"};
+    run_with_arguments<T, N>(state, [&](const auto&... arguments) {
+      bench::do_not_optimize(person);
+      std::visit([&](auto& alternative) { alternative.do_work(arguments...); }, person);
+    });
+  }
+
+  static void any_person(bench::State& state) {
+    AnyPerson person{typename Types::Person{"Peter"}};
+    run_with_arguments<T, N>(state, [&](const auto&... arguments) {
+      Library::OutputRecord record;
+      record.drop();
+      person.work(arguments...);
+    });
+  }
+
+  static void office(bench::State& state) {
+    Library::Office office{typename Types::Person{"Peter"}};
+    run_with_arguments<T, N>(state, [&](const auto&... arguments) { office.work(arguments...); });
+  }
+};
+
+template<typename T, std::size_t... Ns>
+void register_cases(const char* type, std::index_sequence<Ns...>) {
+  const auto register_arity = [type]<std::size_t N>(std::integral_constant<std::size_t, N>) {
+    const std::string suffix = std::string("<") + type + ">/" + std::to_string(N);
+    bench::register_benchmark("direct" + suffix, &Cases<T, N>::direct);
+    bench::register_benchmark("virtual" + suffix, &Cases<T, N>::virtual_call);
+    bench::register_benchmark("function" + suffix, &Cases<T, N>::function);
+    bench::register_benchmark("variant" + suffix, &Cases<T, N>::variant);
+    bench::register_benchmark("AnyPerson" + suffix, &Cases<T, N>::any_person);
+    bench::register_benchmark("Office" + suffix, &Cases<T, N>::office);
+  };
+  (register_arity(std::integral_constant<std::size_t, Ns>()), ...);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+  const bench::SilenceCout silence;
+  register_cases<Small>("Small", std::make_index_sequence<9>());
+  register_cases<Large>("Large", std::index_sequence<1, 2, 3, 4, 5, 6, 7, 8>());
+  return bench::run_benchmarks(argc, argv);
+}
@@ -0,0 +1,52 @@
+// Measures `AnyPerson::work()` over a heterogeneous, randomly ordered stream of `Cook`s
+// and `Programmer`s with the two dispatch policies: `VirtualDispatch` (the holder's
+// compiler-generated vtable) and `InlineVTableDispatch` (function pointers stored in
+// `BasicAnyPerson` itself).
+
+#include "Bench.h"
+#include "Persons.h"
+
+#include <random>
+
+namespace {
+
+template<typename Dispatch>
+void run(const char* name, const std::vector<bool>& is_cook) {
+  using Person = BasicAnyPerson<Dispatch>;
+  std::vector<Person> persons;
+  persons.reserve(is_cook.size());
+  for (const bool cook : is_cook) {
+    if (cook) {
+      persons.emplace_back(Cook{"Alice"});
+    } else {
+      persons.emplace_back(Programmer{"Peter"});
+    }
+  }
+
+  constexpr std::size_t kIterations = 1'000'000;
+  std::size_t i = 0;
+  bench::report(name, bench::measure(kIterations, [&] {
+    const std::size_t index = i++ % persons.size();
+    if (is_cook[index]) {
+      persons[index].work(Recipe{}, IngredientList{});
+    } else {
+      persons[index].work(Monitor{}, Keyboard{}, Cup{});
+    }
+  }));
+  std::printf("  sizeof(BasicAnyPerson) = %zu\n", sizeof(Person));
+}
+
+} // namespace
+
+int main() {
+  const bench::SilenceCout silence;
+
+  std::vector<bool> is_cook(4096);
+  std::mt19937 random(42);
+  for (std::size_t i = 0; i < is_cook.size(); ++i) {
+    is_cook[i] = random() % 2 == 0;
+  }
+
+  run<VirtualDispatch>("VirtualDispatch", is_cook);
+  run<InlineVTableDispatch>("InlineVTableDispatch", is_cook);
+}
@@ -0,0 +1,50 @@
+// Measures the throughput of `Office::submit_work()` on a `Library::Executor` with 1 to N
+// threads (N defaults to the number of hardware threads, and at least 4), for a mix of
+// `Cook` and `Programmer` work. The work is submitted by tasks running on the executor,
+// one per thread, so that it goes through the threads' own deques and gets stolen by
+// whichever thread runs out of work.
+
+#include "Bench.h"
+#include "Persons.h"
+
+#include <cstdlib>
+
+int main(int argc, char* argv[]) {
+  constexpr std::size_t kWorks = 1 << 20;
+  const unsigned max_threads = argc > 1 ? static_cast<unsigned>(std::atoi(argv[1]))
+                                        : std::max(Library::Executor::default_thread_count(), 4u);
+  const bench::SilenceCout silence;
+  Library::Office cook{Cook{"Alice"}};
+  Library::Office programmer{Programmer{"Peter"}};
+  const IngredientList ingredients{"flour", "eggs", "milk"};
+
+  double single_thread_ns = 0.0;
+  for (unsigned threads = 1; threads <= max_threads; threads *= 2) {
+    Library::Executor executor(threads);
+    const std::size_t per_producer = kWorks / threads;
+    const bench::Result run = bench::measure(1, [&] {
+      for (unsigned producer = 0; producer < threads; ++producer) {
+        executor.submit([&, producer] {
+          for (std::size_t i = 0; i < per_producer; ++i) {
+            if ((i + producer) % 4 == 0) {
+              cook.submit_work(executor, Recipe{}, ingredients);
+            } else {
+              programmer.submit_work(executor, Monitor{}, Keyboard{}, Cup{});
+            }
+          }
+        });
+      }
+      executor.wait_idle();
+    });
+    const double works = static_cast<double>(per_producer * threads);
+    const bench::Result per_work{run.ns_per_op / works, run.allocs_per_op / works, run.bytes_per_op / works};
+    if (threads == 1) {
+      single_thread_ns = per_work.ns_per_op;
+    }
+    const std::string name = "submit_work(), " + std::to_string(threads) + " threads, per work";
+    bench::report(name.c_str(), per_work);
+    std::printf("  %.2f M works/s, %.2fx the single thread\n",
+                1e3 / per_work.ns_per_op, single_thread_ns / per_work.ns_per_op);
+  }
+  std::printf("(%u hardware threads)\n", std::thread::hardware_concurrency());
+}
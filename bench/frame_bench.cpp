@@ -0,0 +1,89 @@
+// Measures `Office::work(Monitor{}, Keyboard{}, Cup{})` with the arguments, which are
+// empty and trivially copyable, packed in a `detail::PackedFrame` of no bytes, and with
+// them passed by address in a `detail::ArgRefFrame` (as non-const lvalues are), against
+// the previous implementation, which collected them into `std::vector<std::any>`
+// (reproduced below as `LegacyAnyPerson`).
+
+#include "Bench.h"
+#include "Persons.h"
+
+#include <any>
+#include <memory>
+
+namespace {
+
+class LegacyAnyPerson {
+public:
+  template<typename P>
+  LegacyAnyPerson(P&& person)
+    : m_personHolder(make_holder(std::forward<P>(person), &std::remove_reference_t<P>::do_work))
+  {}
+
+  [[nodiscard]] Library::Name name() const noexcept { return m_personHolder->name(); }
+
+  template<typename... Args>
+  void work(Args&&... arguments) {
+    std::vector<std::any> any_arguments;
+    (any_arguments.push_back(std::forward<Args>(arguments)), ...);
+    return m_personHolder->invoke_work(std::move(any_arguments));
+  }
+
+private:
+  struct IPersonHolder {
+    virtual ~IPersonHolder() = default;
+    virtual Library::Name name() const noexcept       = 0;
+    virtual void invoke_work(std::vector<std::any>&& args) = 0;
+  };
+
+  template<typename P, typename... Args>
+  struct PersonHolder : public IPersonHolder {
+    template<typename Q>
+    explicit PersonHolder(Q&& person) : m_person(std::forward<Q>(person)) { }
+    [[nodiscard]] Library::Name name() const noexcept override { return m_person.name(); }
+    void invoke_work(std::vector<std::any>&& arguments) override {
+      Library::out() << "working on ";
+      invoke_work_impl(std::move(arguments), std::make_index_sequence<sizeof...(Args)>());
+    }
+  private:
+    template<size_t... Is>
+    void invoke_work_impl(std::vector<std::any>&& arguments, std::index_sequence<Is...>) {
+      return m_person.do_work(std::move(std::any_cast<Args>(arguments[Is]))...);
+    }
+    P m_person;
+  };
+
+  template<typename P, typename... Args>
+  std::unique_ptr<IPersonHolder> make_holder(P&& person, void(std::remove_reference_t<P>::*)(Args...)) {
+    return std::make_unique<PersonHolder<P, Args...>>(std::forward<P>(person));
+  }
+
+  std::unique_ptr<IPersonHolder> m_personHolder;
+};
+
+} // namespace
+
+int main() {
+  constexpr std::size_t kIterations = 1'000'000;
+  const bench::SilenceCout silence;
+
+  LegacyAnyPerson legacy{Programmer{"Peter"}};
+  bench::report("std::vector<std::any> (before)", bench::measure(kIterations, [&] {
+    const Library::OutputRecord record;
+    Library::out() << legacy.name() << " is ";
+    legacy.work(Monitor{}, Keyboard{}, Cup{});
+  }));
+
+  Library::Office office{Programmer{"Peter"}};
+  Monitor monitor;
+  Keyboard keyboard;
+  Cup cup;
+  static_assert(!detail::kPassPacked<Monitor&, Keyboard&, Cup&>);
+  bench::report("detail::ArgRefFrame", bench::measure(kIterations, [&] {
+    office.work(monitor, keyboard, cup);
+  }));
+
+  static_assert(detail::kPassPacked<Monitor, Keyboard, Cup> && detail::PackedLayout<Monitor, Keyboard, Cup>::size == 0);
+  bench::report("detail::PackedFrame", bench::measure(kIterations, [&] {
+    office.work(Monitor{}, Keyboard{}, Cup{});
+  }));
+}
@@ -0,0 +1,77 @@
+// Measures building recipes of 10, 1k and 100k ingredients, and `Office::work()` on them,
+// with an `IngredientList` against the previous `std::vector<Ingredient>`, in which each
+// ingredient owns its name.
+
+#include "Bench.h"
+#include "Persons.h"
+
+#include <algorithm>
+#include <array>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+// An ingredient as before, owning its name
+struct LegacyIngredient {
+  explicit LegacyIngredient(std::string name) : m_name(std::move(name)) {}
+  [[nodiscard]] const std::string& name() const noexcept { return m_name; }
+private:
+  std::string m_name;
+};
+
+// A cook as before, taking a vector of ingredients
+class LegacyCook : public Library::Person {
+public:
+  using Library::Person::Person;
+  void do_work(Recipe recipe, const std::vector<LegacyIngredient>& ingredients) {
+    Library::out() << recipe.name() <<" with "<< ingredients.size() <<" ingredients: ";
+    bool first = true;
+    for (const auto& i : ingredients) {
+      Library::out() << (first? "" : ", ") << i.name();
+      first = false;
+    }
+  }
+};
+
+constexpr std::array<std::string_view, 8> kNames{
+  "flour", "eggs", "milk", "butter", "sugar", "vanilla extract", "baking powder", "unsalted roasted pistachios",
+};
+
+void run(std::size_t count) {
+  const std::size_t iterations = std::max<std::size_t>(10, 1'000'000 / count);
+  std::printf("%zu ingredients\n", count);
+
+  std::vector<LegacyIngredient> vector;
+  bench::report("  build std::vector<Ingredient> (before)", bench::measure(iterations, [&] {
+    std::vector<LegacyIngredient> built;
+    for (std::size_t i = 0; i < count; ++i) {
+      built.push_back(LegacyIngredient{std::string(kNames[i % kNames.size()])});
+    }
+    vector = std::move(built);
+  }));
+  IngredientList list;
+  bench::report("  build IngredientList", bench::measure(iterations, [&] {
+    IngredientList built;
+    for (std::size_t i = 0; i < count; ++i) {
+      built.push_back(kNames[i % kNames.size()]);
+    }
+    list = std::move(built);
+  }));
+
+  Library::Office legacy_cook{LegacyCook{"Alice"}};
+  bench::report("  work() on std::vector<Ingredient> (before)",
+                bench::measure(iterations, [&] { legacy_cook.work(Recipe{}, vector); }));
+  Library::Office cook{Cook{"Alice"}};
+  bench::report("  work() on IngredientList", bench::measure(iterations, [&] { cook.work(Recipe{}, list); }));
+}
+
+} // namespace
+
+int main() {
+  const bench::SilenceCout silence;
+  for (const std::size_t count : std::array<std::size_t, 3>{10, 1'000, 100'000}) {
+    run(count);
+  }
+}
@@ -0,0 +1,39 @@
+// Measures the cost of calling `Office::work()` with mismatched arguments: reported by
+// `try_work()` as a `Library::WorkResult`, or thrown by `work()` as
+// `Library::BadWorkArguments` when exceptions are enabled. Built twice, as
+// mismatch_bench and mismatch_bench_noexcept (-fno-exceptions).
+
+#include "Bench.h"
+#include "Persons.h"
+
+int main() {
+  constexpr std::size_t kIterations = 1'000'000;
+  const bench::SilenceCout silence;
+  Library::Office office{Programmer{"Peter"}};
+
+#if LIBRARY_HAS_EXCEPTIONS
+  std::printf("exceptions enabled\n");
+#else
+  std::printf("exceptions disabled\n");
+#endif
+
+  bench::report("try_work(Monitor, Keyboard, Cup) (match)", bench::measure(kIterations, [&] {
+    bench::do_not_optimize(office.try_work(Monitor{}, Keyboard{}, Cup{}));
+  }));
+  bench::report("try_work(Monitor, Cup, Cup) (mismatch)", bench::measure(kIterations, [&] {
+    bench::do_not_optimize(office.try_work(Monitor{}, Cup{}, Cup{}));
+  }));
+  bench::report("try_work(Monitor) (wrong arity)", bench::measure(kIterations, [&] {
+    bench::do_not_optimize(office.try_work(Monitor{}));
+  }));
+
+#if LIBRARY_HAS_EXCEPTIONS
+  bench::report("work(Monitor, Cup, Cup) + catch (mismatch)", bench::measure(kIterations, [&] {
+    try {
+      office.work(Monitor{}, Cup{}, Cup{});
+    } catch (const Library::BadWorkArguments& e) {
+      bench::do_not_optimize(e);
+    }
+  }));
+#endif
+}
@@ -0,0 +1,114 @@
+// Measures handing a 1 MB payload to `do_work()` as a `std::unique_ptr<std::vector<char>>`,
+// whose ownership is transferred, against a `std::vector<char>` taken by value and copied,
+// through `Office::work()`, `submit_work()` and `work_async()`. The person, `Courier`, is
+// move-only itself. Checks that each payload arrives without being copied.
+
+#include "Bench.h"
+#include "Persons.h"
+
+#include <algorithm>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+using Payload = std::unique_ptr<std::vector<char>>;
+
+constexpr std::size_t kPayloadSize = 1 << 20;
+
+// Where the payloads end up, to be freed outside of the measured calls
+std::vector<Payload> g_delivered;
+
+// Move-only, as it owns its count of deliveries through a `std::unique_ptr`
+class Courier : public Library::Person {
+public:
+  explicit Courier(std::string_view name) : Person(name), m_deliveries(std::make_unique<std::size_t>(0)) {}
+  void do_work(Payload payload) {
+    Library::out() << "delivering " << payload->size() << " bytes";
+    g_delivered.push_back(std::move(payload));
+    ++*m_deliveries;
+  }
+private:
+  std::unique_ptr<std::size_t> m_deliveries;
+};
+
+class CopyingCourier : public Library::Person {
+public:
+  using Library::Person::Person;
+  void do_work(std::vector<char> payload) {
+    Library::out() << "delivering " << payload.size() << " bytes";
+    bench::do_not_optimize(payload);
+  }
+};
+
+} // namespace
+
+int main() {
+  constexpr std::size_t kIterations = 256; // at most 256 MB of payloads at once
+  const bench::SilenceCout silence;
+  static_assert(!std::is_copy_constructible_v<Courier>);
+
+  // The payloads are made outside of the measured calls, and must each be delivered
+  // itself, leaving the caller's empty (in any order, as the executor's queue isn't FIFO).
+  std::vector<Payload> payloads(kIterations);
+  std::vector<const std::vector<char>*> addresses(kIterations);
+  const auto refill = [&] {
+    for (std::size_t j = 0; j < kIterations; ++j) {
+      payloads[j]  = std::make_unique<std::vector<char>>(kPayloadSize, 'x');
+      addresses[j] = payloads[j].get();
+    }
+  };
+  const auto check_delivered = [&](const char* message) {
+    std::vector<const std::vector<char>*> delivered;
+    for (const Payload& payload : g_delivered) {
+      delivered.push_back(payload.get());
+    }
+    std::sort(delivered.begin(), delivered.end());
+    std::sort(addresses.begin(), addresses.end());
+    bench::check(delivered == addresses, message);
+    bench::check(std::all_of(payloads.begin(), payloads.end(), [](const Payload& p) { return p == nullptr; }), message);
+    g_delivered.clear();
+  };
+  const std::vector<char> vector(kPayloadSize, 'x');
+
+  Library::Office office{Courier{"Cora"}};
+  Library::Office copying{CopyingCourier{"Carl"}};
+  std::size_t i = 0;
+
+  g_delivered.reserve(kIterations);
+  refill();
+  bench::report("work(unique_ptr), ownership transfer", bench::measure(kIterations, [&] {
+    office.work(std::move(payloads[i++]));
+  }));
+  check_delivered("work() didn't hand over the payloads themselves");
+  bench::report("work(vector) by value, copy (before)", bench::measure(kIterations, [&] { copying.work(vector); }));
+
+  Library::Executor executor(1);
+  refill();
+  i = 0;
+  bench::report("submit_work(unique_ptr), ownership transfer", bench::measure(kIterations, [&] {
+    office.submit_work(executor, std::move(payloads[i++]));
+  }));
+  executor.wait_idle();
+  check_delivered("submit_work() didn't hand over the payloads themselves");
+  bench::report("submit_work(vector), copy (before)", bench::measure(kIterations, [&] {
+    copying.submit_work(executor, vector);
+  }));
+  executor.wait_idle();
+
+  refill();
+  i = 0;
+  bench::report("work_async(unique_ptr).get(), ownership transfer", bench::measure(kIterations, [&] {
+    office.work_async(executor, std::move(payloads[i++])).get();
+  }));
+  check_delivered("work_async() didn't hand over the payloads themselves");
+  bench::report("work_async(vector).get(), copy (before)", bench::measure(kIterations, [&] {
+    copying.work_async(executor, vector).get();
+  }));
+
+  // A move-only argument that isn't an rvalue can't be moved from: it's reported, not copied.
+  Payload kept = std::make_unique<std::vector<char>>(kPayloadSize);
+  const Library::WorkResult result = office.try_work(kept);
+  bench::check(result.status() == Library::WorkStatus::Unsupported && kept != nullptr, "an lvalue payload was moved from");
+}
@@ -0,0 +1,77 @@
+// Counts the heap allocations of 1M `Programmer::do_work()` calls, whose items have
+// compile-time `std::string_view` names, against the previous items, which returned a
+// new `std::string` per call, and of 1M copies of a `Programmer`, whose name is interned,
+// against a person that owns a `std::string` name. The names are longer than the small
+// string buffer of `std::string`, as a name like "Maximilian Alexander" would be.
+
+#include "Bench.h"
+#include "Persons.h"
+
+#include <string>
+
+using namespace std::string_literals;
+
+namespace {
+
+struct LegacyMonitor  { [[nodiscard]] std::string name() const { return "widescreen monitor"s; } };
+struct LegacyKeyboard { [[nodiscard]] std::string name() const { return "mechanical keyboard"s; } };
+struct LegacyCup      { [[nodiscard]] std::string name() const { return "double espresso cup"s; } };
+
+struct WideMonitor  { [[nodiscard]] static constexpr std::string_view name() noexcept { return "widescreen monitor"; } };
+struct MechKeyboard { [[nodiscard]] static constexpr std::string_view name() noexcept { return "mechanical keyboard"; } };
+struct EspressoCup  { [[nodiscard]] static constexpr std::string_view name() noexcept { return "double espresso cup"; } };
+
+template<typename M, typename K, typename C>
+class Writer : public Library::Person {
+public:
+  using Library::Person::Person;
+  void do_work(M monitor, K keyboard, C coffee) {
+    Library::out() << keyboard.name() <<", "<< monitor.name() <<", and "<< coffee.name();
+  }
+};
+
+// A person as before, owning its name
+class LegacyPerson {
+public:
+  explicit LegacyPerson(std::string name) : m_name(std::move(name)) {}
+  [[nodiscard]] const std::string& name() const noexcept { return m_name; }
+private:
+  std::string m_name;
+};
+
+constexpr std::size_t kCalls = 1'000'000;
+constexpr const char* kLongName = "Maximilian Alexander";
+
+template<typename P, typename... Items>
+bench::Result measure_do_work(P& person) {
+  return bench::measure(kCalls, [&] {
+    const Library::OutputRecord record;
+    person.do_work(Items{}...);
+  });
+}
+
+} // namespace
+
+int main() {
+  const bench::SilenceCout silence;
+
+  Programmer peter{"Peter"};
+  bench::report("Programmer::do_work(), string_view names", measure_do_work<Programmer, Monitor, Keyboard, Cup>(peter));
+  Writer<WideMonitor, MechKeyboard, EspressoCup> writer{kLongName};
+  bench::report("long string_view names",
+                measure_do_work<decltype(writer), WideMonitor, MechKeyboard, EspressoCup>(writer));
+  Writer<LegacyMonitor, LegacyKeyboard, LegacyCup> legacy_writer{kLongName};
+  bench::report("long std::string names (before)",
+                measure_do_work<decltype(legacy_writer), LegacyMonitor, LegacyKeyboard, LegacyCup>(legacy_writer));
+
+  const Programmer maximilian{kLongName};
+  bench::report("copy a Programmer, interned name", bench::measure(kCalls, [&] {
+    Programmer copy = maximilian;
+    bench::do_not_optimize(copy);
+  }));
+  const LegacyPerson legacy{kLongName};
+  bench::report("copy a person with a std::string name (before)", bench::measure(kCalls, [&] {
+    LegacyPerson copy = legacy;
+    bench::do_not_optimize(copy);
+  }));
+}
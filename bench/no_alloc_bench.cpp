@@ -0,0 +1,71 @@
+// Checks that the steady state of the example in main.cpp doesn't allocate: the calling
+// thread runs `Office::work()` and `AnyPerson::work()` for `Cook` and `Programmer` under
+// a `bench::NoAllocGuard` in `Fail` mode, which aborts on the first allocation, once the
+// caches and buffers these calls fill have been warmed up. Then counts the allocations,
+// in `Count` mode, over many calls, and checks that the guard sees the allocations of the
+// parts of main.cpp that do allocate: building the `IngredientList`.
+
+#include "Bench.h"
+#include "Persons.h"
+
+namespace {
+
+constexpr std::size_t kWarmUp = 10'000;
+constexpr std::size_t kChecked = 100'000;
+
+// Runs `op()` `kWarmUp` times unguarded, then `kChecked` times under a guard in `Fail`
+// mode, and then reports the allocations of `kChecked` calls counted by a guard in
+// `Count` mode.
+template<typename Op>
+void run(const char* what, Op&& op) {
+  for (std::size_t i = 0; i < kWarmUp; ++i) {
+    op();
+  }
+  for (std::size_t i = 0; i < kChecked; ++i) {
+    const bench::NoAllocGuard guard(what);
+    op();
+  }
+  const bench::NoAllocGuard guard(what, bench::NoAllocGuard::Mode::Count);
+  for (std::size_t i = 0; i < kChecked; ++i) {
+    op();
+  }
+  const bench::AllocStats a = guard.allocations();
+  std::printf("%-58s %8.2f allocs/op %8.2f frees/op: ok\n", what,
+              static_cast<double>(a.count) / kChecked, static_cast<double>(a.frees) / kChecked);
+}
+
+} // namespace
+
+int main() {
+  const bench::SilenceCout silence;
+
+  Library::Office cook{Cook{"Alice"}};
+  const IngredientList ingredients{"flour", "eggs", "milk"};
+  run("Office::work(Recipe{}, ingredients), Cook", [&] { cook.work(Recipe{}, ingredients); });
+
+  Library::Office programmer{Programmer{"Peter"}};
+  run("Office::work(Monitor{}, Keyboard{}, Cup{}), Programmer", [&] {
+    programmer.work(Monitor{}, Keyboard{}, Cup{});
+  });
+
+  // As main.cpp does it, constructing the office for each call
+  run("Office{Programmer{\"Peter\"}}.work(...), as in main.cpp", [] {
+    Library::Office{Programmer{"Peter"}}.work(Monitor{}, Keyboard{}, Cup{});
+  });
+
+  AnyPerson alice{Cook{"Alice"}};
+  run("AnyPerson::work(Recipe{}, ingredients), Cook", [&] {
+    const Library::OutputRecord record;
+    alice.work(Recipe{}, ingredients);
+  });
+  AnyPerson peter{Programmer{"Peter"}};
+  run("AnyPerson::work(Monitor{}, Keyboard{}, Cup{}), Programmer", [&] {
+    const Library::OutputRecord record;
+    peter.work(Monitor{}, Keyboard{}, Cup{});
+  });
+
+  // The guard does see allocations: building the ingredients allocates their buffers.
+  const bench::NoAllocGuard guard("IngredientList{...}", bench::NoAllocGuard::Mode::Count);
+  cook.work(Recipe{}, IngredientList{"flour", "eggs", "milk"});
+  bench::check(guard.allocations().count > 0, "the guard missed the allocations of an IngredientList");
+}
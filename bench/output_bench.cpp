@@ -0,0 +1,62 @@
+// Measures `Office::work()` writing 10M records ("Peter is working on keyboard, monitor,
+// and coffee") to a file through a `Library::FileSink`, with each flush policy, against
+// the original code's `std::cout << ... << std::endl`, emulated with a `std::ofstream`,
+// whose `std::endl` makes a system call per line.
+//
+// Usage: output_bench [file [calls]]; the file (output_bench.txt by default) is removed.
+
+#include "Bench.h"
+#include "Persons.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+
+namespace {
+
+void report(const char* name, const bench::Result& r, const char* path) {
+  bench::report(name, r);
+  std::FILE* file = std::fopen(path, "rb");
+  std::fseek(file, 0, SEEK_END);
+  const long bytes = std::ftell(file);
+  std::fclose(file);
+  std::printf("  %.1f M calls/s, %.1f MB written\n", 1e3 / r.ns_per_op, static_cast<double>(bytes) / 1e6);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+  const char* path = argc > 1 ? argv[1] : "output_bench.txt";
+  const std::size_t calls = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 10'000'000;
+  Library::Office office{Programmer{"Peter"}};
+
+  {
+    std::ofstream file(path);
+    const Monitor monitor;
+    const Keyboard keyboard;
+    const Cup coffee;
+    report("std::endl per line (before)", bench::measure(calls, [&] {
+      file << "Peter" << " is " << "working on " << keyboard.name() << ", " << monitor.name()
+           << ", and " << coffee.name() << std::endl;
+    }), path);
+  }
+
+  const std::pair<const char*, Library::FlushPolicy> policies[] = {
+    {"FileSink, FlushPolicy::per_record()", Library::FlushPolicy::per_record()},
+    {"FileSink, FlushPolicy::size(64 KiB)", Library::FlushPolicy::size(64 * 1024)},
+    {"FileSink, FlushPolicy::every(10 ms)", Library::FlushPolicy::every(std::chrono::milliseconds(10))},
+  };
+  for (const auto& [name, policy] : policies) {
+    std::FILE* file = std::fopen(path, "wb");
+    {
+      Library::FileSink sink(file);
+      Library::set_output(sink, policy);
+      const bench::Result r = bench::measure(calls, [&] { office.work(Monitor{}, Keyboard{}, Cup{}); });
+      Library::reset_output();
+      std::fclose(file);
+      report(name, r, path);
+    }
+  }
+  std::remove(path);
+}
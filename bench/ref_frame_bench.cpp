@@ -0,0 +1,36 @@
+// Measures `AnyPerson::work()` with a 1 MB `std::vector<char>` argument, which `do_work()`
+// takes by const reference, passed in a `detail::ArgRefFrame`, which refers to the
+// caller's vector, against the value frame that synchronous calls used before, and that
+// queued work still uses, which copies it.
+
+#include "Bench.h"
+#include "Persons.h"
+
+#include <vector>
+
+namespace {
+
+class Archivist : public Library::Person {
+public:
+  using Library::Person::Person;
+  void do_work(const std::vector<char>& data) { Library::out() << "archiving " << data.size() << " bytes"; }
+};
+
+} // namespace
+
+int main() {
+  constexpr std::size_t kIterations = 10'000;
+  const bench::SilenceCout silence;
+  AnyPerson archivist{Archivist{"Ada"}};
+  const std::vector<char> data(1 << 20, 'x');
+
+  bench::report("1 MB vector, detail::ArgFrame (before)", bench::measure(kIterations, [&] {
+    const Library::OutputRecord record;
+    ::detail::ArgFrame<std::vector<char>> frame(data);
+    static_cast<void>(archivist.try_work_frame(frame.ref()));
+  }));
+  bench::report("1 MB vector, detail::ArgRefFrame (after)", bench::measure(kIterations, [&] {
+    const Library::OutputRecord record;
+    archivist.work(data);
+  }));
+}
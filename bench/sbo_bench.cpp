@@ -0,0 +1,32 @@
+// Measures construction of `Library::Office` from a small `Library::Person`, which is
+// stored inside `AnyPerson` and therefore shouldn't allocate, against an `AnyPerson`
+// without an inline buffer, which always puts the person on the heap.
+
+#include "Bench.h"
+#include "Persons.h"
+
+int main() {
+  constexpr std::size_t kIterations = 1'000'000;
+  // Interns the name up front, as the first person named "Alice" would (see Names.h)
+  const Library::Name alice{"Alice"};
+
+  const auto inline_office = bench::measure(kIterations, [] {
+    Library::Office office{Cook{"Alice"}};
+    bench::do_not_optimize(office);
+  });
+  bench::report("Office{Cook{\"Alice\"}}", inline_office);
+
+  const auto heap_person = bench::measure(kIterations, [] {
+    BasicAnyPerson<VirtualDispatch, 0> person{Cook{"Alice"}};
+    bench::do_not_optimize(person);
+  });
+  bench::report("BasicAnyPerson<VirtualDispatch, 0>{Cook{\"Alice\"}} (heap only)", heap_person);
+
+  const auto inline_person = bench::measure(kIterations, [] {
+    AnyPerson person{Cook{"Alice"}};
+    bench::do_not_optimize(person);
+  });
+  bench::report("AnyPerson{Cook{\"Alice\"}}", inline_person);
+
+  return inline_office.allocs_per_op == 0.0 ? 0 : 1;
+}
@@ -0,0 +1,35 @@
+// Measures `Office::work()` for `Programmer` with the USDT probes of Probes.h compiled
+// out or in: built twice, as usdt_bench (as ENABLE_USDT says, off by default) and
+// usdt_bench_enabled (LIBRARY_USDT=1). With the probes compiled in, measures them both
+// disabled, as they are until a tracer attaches, and enabled, by setting their semaphores
+// as a tracer would (without a tracer, the probes' `nop`s don't trap, so this only
+// measures computing their arguments). The probes can be listed with
+//   readelf -n usdt_bench_enabled | grep -A3 stapsdt
+
+#include "Bench.h"
+#include "Persons.h"
+
+int main() {
+  constexpr std::size_t kIterations = 1'000'000;
+  const bench::SilenceCout silence;
+  Library::Office office{Programmer{"Peter"}};
+
+#if LIBRARY_HAS_USDT
+  bench::report("work(Monitor{}, Keyboard{}, Cup{}), probes disabled", bench::measure(kIterations, [&] {
+    office.work(Monitor{}, Keyboard{}, Cup{});
+  }));
+  library_office_work_entry_semaphore = 1;
+  library_invoke_work_semaphore       = 1;
+  library_do_work_return_semaphore    = 1;
+  bench::report("work(Monitor{}, Keyboard{}, Cup{}), probes enabled", bench::measure(kIterations, [&] {
+    office.work(Monitor{}, Keyboard{}, Cup{});
+  }));
+  library_office_work_entry_semaphore = 0;
+  library_invoke_work_semaphore       = 0;
+  library_do_work_return_semaphore    = 0;
+#else
+  bench::report("work(Monitor{}, Keyboard{}, Cup{}), probes compiled out", bench::measure(kIterations, [&] {
+    office.work(Monitor{}, Keyboard{}, Cup{});
+  }));
+#endif
+}
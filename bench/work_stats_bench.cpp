@@ -0,0 +1,99 @@
+// Measures `Office::work()` for `Programmer` and `Cook` with the per-holder stats of
+// WorkStats.h compiled in or out: built twice, as work_stats_bench (as ENABLE_WORK_STATS
+// says, off by default) and work_stats_bench_enabled (LIBRARY_WORK_STATS=1). Then has a
+// few threads work, returns mismatched arguments and arguments passed in a way `do_work()`
+// can't take, and, with the stats compiled in, prints them, merged over all threads, and
+// checks the counts.
+
+#include "Bench.h"
+#include "Persons.h"
+
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// Takes a move-only argument by value, which an lvalue can't be moved into
+class Archivist : public Library::Person {
+public:
+  using Library::Person::Person;
+  void do_work(std::unique_ptr<int> document) { bench::do_not_optimize(document); }
+};
+
+} // namespace
+
+int main() {
+  constexpr std::size_t kIterations = 1'000'000;
+  constexpr std::size_t kThreads    = 4;
+  constexpr std::size_t kMismatches = 1'000;
+  constexpr std::size_t kUnsupported = 100;
+  const bench::SilenceCout silence;
+
+#if LIBRARY_WORK_STATS
+  std::printf("work stats compiled in\n");
+#else
+  std::printf("work stats compiled out\n");
+#endif
+
+  Library::Office programmer{Programmer{"Peter"}};
+  bench::report("work(Monitor{}, Keyboard{}, Cup{}), Programmer", bench::measure(kIterations, [&] {
+    programmer.work(Monitor{}, Keyboard{}, Cup{});
+  }));
+  Library::Office cook{Cook{"Alice"}};
+  const IngredientList ingredients{"flour", "eggs", "milk"};
+  bench::report("work(Recipe{}, ingredients), Cook", bench::measure(kIterations, [&] {
+    cook.work(Recipe{}, ingredients);
+  }));
+
+  // Threads that end before the snapshot: their shards are kept.
+  std::vector<std::thread> threads;
+  for (std::size_t t = 0; t < kThreads; ++t) {
+    threads.emplace_back([&] {
+      Library::Office office{Programmer{"Paula"}};
+      for (std::size_t i = 0; i < kIterations / kThreads; ++i) {
+        office.work(Monitor{}, Keyboard{}, Cup{});
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  for (std::size_t i = 0; i < kMismatches; ++i) {
+    bench::do_not_optimize(programmer.try_work(Cup{}));
+  }
+  Library::Office archivist{Archivist{"Arthur"}};
+  const auto document = std::make_unique<int>(42);
+  for (std::size_t i = 0; i < kUnsupported; ++i) {
+    bench::do_not_optimize(archivist.try_work(document));
+  }
+
+  const std::vector<Library::PersonStats> stats = Library::work_stats();
+#if LIBRARY_WORK_STATS
+  for (const Library::PersonStats& person : stats) {
+    const Library::LatencyHistogram& latency = person.latency;
+    std::printf("%-12.*s %9llu calls %6llu mismatches %4llu unsupported, ns: mean %7.1f p50 %5llu p99 %6llu "
+                "p99.9 %7llu max %9llu\n",
+                static_cast<int>(person.person.size()), person.person.data(),
+                static_cast<unsigned long long>(person.calls), static_cast<unsigned long long>(person.mismatches),
+                static_cast<unsigned long long>(person.unsupported),
+                latency.mean(), static_cast<unsigned long long>(latency.percentile(0.5)),
+                static_cast<unsigned long long>(latency.percentile(0.99)),
+                static_cast<unsigned long long>(latency.percentile(0.999)),
+                static_cast<unsigned long long>(latency.max()));
+  }
+  // `bench::measure()` calls each operation exactly `kIterations` times, with no warm-up,
+  // and the threads call `Programmer` as many times again.
+  bench::check(stats.size() == 3 && stats[0].type == Library::type_id<Programmer>() &&
+        stats[1].type == Library::type_id<Cook>() && stats[2].type == Library::type_id<Archivist>() &&
+        stats[0].person == Library::type_name<Programmer>(), "unexpected persons");
+  bench::check(stats[0].calls == 2 * kIterations && stats[0].mismatches == kMismatches &&
+        stats[0].unsupported == 0 && stats[0].latency.count() == stats[0].calls, "unexpected counts for Programmer");
+  bench::check(stats[1].calls == kIterations && stats[1].mismatches == 0 && stats[1].unsupported == 0,
+        "unexpected counts for Cook");
+  bench::check(stats[2].calls == 0 && stats[2].mismatches == 0 && stats[2].unsupported == kUnsupported,
+        "unexpected counts for Archivist");
+#else
+  bench::check(stats.empty(), "stats recorded while compiled out");
+#endif
+}
@@ -0,0 +1,570 @@
+#pragma once
+
+#include "ArgFrame.h"
+#include "Columns.h"
+#include "Names.h"
+#include "Output.h"
+#include "Probes.h"
+#include "WorkErrors.h"
+#include "WorkStats.h"
+#include "WorkTask.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <new>
+#include <span>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace Library { class Person; }
+
+namespace detail {
+  struct IPersonHolder {
+    virtual ~IPersonHolder() = default;
+    virtual Library::Name name() const noexcept                                               = 0;
+    virtual const Signature& signature() const noexcept                                       = 0;
+    // If `do_work()` is a coroutine, stores it in `*task`, or leaves it detached if
+    // `task` is nullptr.
+    virtual Library::WorkResult invoke_work(const ArgFrameRef& args, Library::WorkTask* task) = 0;
+    virtual Library::WorkResult invoke_work_batch(const BatchRef& batch)                      = 0;
+    virtual Library::WorkResult invoke_work_columns(const ColumnsRef& columns)                = 0;
+    // Move-constructs this holder into `buffer`, which is known to fit it.
+    virtual IPersonHolder* move_into(void* buffer)                                            = 0;
+    // Deletes this holder, which is on the heap, once the coroutines that `do_work()`
+    // started, if any, are done with it too.
+    virtual void release() noexcept                                                           = 0;
+  };
+
+  // Owns a person of type `P`, moved into it (or copied, from an lvalue), so that persons
+  // may be move-only, e.g. own a `std::unique_ptr`.
+  template<typename P, typename... Args>
+  struct PersonHolder final : public IPersonHolder {
+    static_assert(std::is_same_v<P, std::decay_t<P>>, "PersonHolder owns its person");
+
+    template<typename Q>
+    explicit PersonHolder(Q&& person) : m_person(std::forward<Q>(person)) { }
+
+    [[nodiscard]] Library::Name name() const noexcept override { return m_person.name(); }
+
+    [[nodiscard]] const Signature& signature() const noexcept override { return kSignature; }
+
+    Library::WorkResult invoke_work(const ArgFrameRef& arguments, Library::WorkTask* task) override {
+#if LIBRARY_WORK_STATS
+      const std::uint64_t start = work_stats_now();
+      const Library::WorkResult result = dispatch(arguments, task);
+      record_work(stats_slot(), result.status(), start);
+      return result;
+#else
+      return dispatch(arguments, task);
+#endif
+    }
+
+    // Checks the signature once for the whole batch, then calls `do_work()` on each item
+    // in a loop the compiler sees through.
+    Library::WorkResult invoke_work_batch(const BatchRef& batch) override {
+      const Signature& signature = *batch.signature;
+      if (const Library::WorkResult result = check_arguments(kSignature, signature); !result) {
+        return result;
+      }
+      if constexpr (kTakesConstArguments && !kIsCoroutine) {
+        const auto* items = static_cast<const std::tuple<std::decay_t<Args>...>*>(batch.items);
+        Library::out() << Library::static_text<"working on a batch of "> << batch.count
+                       << Library::static_text<":\n">;
+        for (std::size_t i = 0; i < batch.count; ++i) {
+          std::apply([this](const auto&... arguments) { m_person.do_work(arguments...); }, items[i]);
+          Library::out() << '\n';
+        }
+        return {};
+      } else {
+        // `do_work()` wants to move from or modify some of its arguments, or is a
+        // coroutine that would outlive them
+        return {Library::WorkStatus::Unsupported, 0, kSignature, signature};
+      }
+    }
+
+    // Checks the signature once, then hands whole columns to `do_work_bulk()` if the
+    // person has one, or calls `do_work()` with each row otherwise.
+    Library::WorkResult invoke_work_columns(const ColumnsRef& columns) override {
+      const Signature& signature = *columns.signature;
+      if (const Library::WorkResult result = check_arguments(kSignature, signature); !result) {
+        return result;
+      }
+      if constexpr (kHasBulk || (kTakesConstArguments && !kIsCoroutine)) {
+        Library::out() << Library::static_text<"working on a batch of "> << columns.count
+                       << Library::static_text<":\n">;
+        invoke_work_columns_impl(columns, std::make_index_sequence<sizeof...(Args)>());
+        return {};
+      } else {
+        return {Library::WorkStatus::Unsupported, 0, kSignature, signature};
+      }
+    }
+
+    IPersonHolder* move_into(void* buffer) override {
+      return ::new (buffer) PersonHolder(std::move(m_person));
+    }
+
+    void release() noexcept override {
+      if constexpr (kIsCoroutine) {
+        if (m_owners.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+          return;
+        }
+      }
+      delete this;
+    }
+  private:
+    using Person = P;
+
+    // Checks the arguments and calls `do_work()` with them.
+    Library::WorkResult dispatch(const ArgFrameRef& arguments, Library::WorkTask* task) {
+#if LIBRARY_HAS_USDT
+      const std::uint64_t entry = LIBRARY_PROBE_ENABLED(invoke_work) ? probe_now() : 0;
+#else
+      const std::uint64_t entry = 0;
+#endif
+      const Signature& signature = arguments.signature();
+      if (const Library::WorkResult result = check_arguments(kSignature, signature); !result) {
+        return result;
+      }
+      assert(signature.arity == kSignature.arity &&
+             std::equal(kSignature.types, kSignature.types + kSignature.arity, signature.types));
+      if constexpr (kReadsPacked) {
+        if (std::byte* bytes = arguments.packed()) {
+          Library::out() << Library::static_text<"working on ">;
+          call_do_work(entry, [&] { invoke_packed(bytes, task, std::make_index_sequence<sizeof...(Args)>()); });
+          return {};
+        }
+      }
+      if (const std::size_t index = first_unbindable(arguments, std::make_index_sequence<sizeof...(Args)>());
+          index < sizeof...(Args)) {
+        // A move-only argument that `do_work()` takes by value, but that it may not move
+        return {Library::WorkStatus::Unsupported, index, kSignature, signature};
+      }
+      Library::out() << Library::static_text<"working on ">;
+      call_do_work(entry, [&] { invoke_work_impl(arguments, task, std::make_index_sequence<sizeof...(Args)>()); });
+      return {};
+    }
+
+    // Calls `do_work()` through `invoke()`, between the `invoke_work` and `do_work_return`
+    // probes, if they're compiled in (see Probes.h). `entry` is when `invoke_work()` was
+    // entered, if its probe is enabled.
+    template<typename Invoke>
+    void call_do_work([[maybe_unused]] std::uint64_t entry, Invoke&& invoke) {
+#if LIBRARY_HAS_USDT
+      if (LIBRARY_PROBE_ENABLED(invoke_work)) {
+        LIBRARY_PROBE3(invoke_work, m_person.name().id(), kSignature.fingerprint, probe_now() - entry);
+      }
+      const std::uint64_t start = LIBRARY_PROBE_ENABLED(do_work_return) ? probe_now() : 0;
+      invoke();
+      if (LIBRARY_PROBE_ENABLED(do_work_return)) {
+        LIBRARY_PROBE3(do_work_return, m_person.name().id(), kSignature.fingerprint, probe_now() - start);
+      }
+#else
+      invoke();
+#endif
+    }
+
+    static constexpr const Signature& kSignature = signature_of<std::decay_t<Args>...>;
+    // Whether `do_work()` can be called with const references to the arguments
+    static constexpr bool kTakesConstArguments =
+      std::is_invocable_v<decltype(&Person::do_work), Person&, const std::decay_t<Args>&...>;
+    // Whether `do_work()` is a coroutine, returning `Library::WorkTask` rather than `void`
+    static constexpr bool kIsCoroutine =
+      std::is_same_v<std::invoke_result_t<decltype(&Person::do_work), Person&, Args...>, Library::WorkTask>;
+    static_assert(!kIsCoroutine || (!std::is_reference_v<Args> && ...),
+                  "a coroutine do_work() outlives the arguments of the call, so it must take them by value");
+    // Whether the person has `do_work_bulk(std::span<const Args>...)`
+    static constexpr bool kHasBulk =
+      requires(Person& person, std::span<const std::decay_t<Args>>... columns) { person.do_work_bulk(columns...); };
+
+    template<size_t... Is>
+    void invoke_work_columns_impl(const ColumnsRef& columns, std::index_sequence<Is...>) {
+      if constexpr (kHasBulk) {
+        m_person.do_work_bulk(std::span(static_cast<const std::decay_t<Args>*>(columns.columns[Is]), columns.count)...);
+      } else {
+        const std::tuple<const std::decay_t<Args>*...> rows{static_cast<const std::decay_t<Args>*>(columns.columns[Is])...};
+        for (std::size_t i = 0; i < columns.count; ++i) {
+          m_person.do_work(std::get<Is>(rows)[i]...);
+          Library::out() << '\n';
+        }
+      }
+    }
+
+    // The index of the first argument that can't be bound to its parameter, or the arity
+    template<size_t... Is>
+    static std::size_t first_unbindable([[maybe_unused]] const ArgFrameRef& arguments, std::index_sequence<Is...>) noexcept {
+      std::size_t index = sizeof...(Args);
+      static_cast<void>(((BoundArgument<Args>::bindable(arguments, Is) || (index = Is, false)) && ...));
+      return index;
+    }
+
+#if LIBRARY_WORK_STATS
+    static std::size_t stats_slot() {
+      static const std::size_t slot =
+        WorkStatsRegistry::instance().slot_of(Library::type_id<Person>(), Library::type_name<Person>());
+      return slot;
+    }
+#endif
+
+    // Whether the frames with arguments of the types of the parameters may be packed
+    static constexpr bool kReadsPacked = PackedLayout<std::decay_t<Args>...>::packable;
+
+    // Passes each argument in a `PackedFrame` straight from its bytes, as the frame holds
+    // copies that `do_work()` may move from or modify.
+    template<size_t... Is>
+    void invoke_packed(std::byte* bytes, [[maybe_unused]] Library::WorkTask* task, std::index_sequence<Is...>) {
+      using Layout = PackedLayout<std::decay_t<Args>...>;
+      if constexpr (kIsCoroutine) {
+        adopt(m_person.do_work(static_cast<Args&&>(Layout::template get<Is>(bytes))...), task);
+      } else {
+        m_person.do_work(static_cast<Args&&>(Layout::template get<Is>(bytes))...);
+      }
+    }
+
+    template<size_t... Is>
+    void invoke_work_impl([[maybe_unused]] const ArgFrameRef& arguments, [[maybe_unused]] Library::WorkTask* task,
+                          std::index_sequence<Is...>) {
+      // Expand the index sequence to bind each argument in the frame to the parameter at
+      // its index, whose type the signature check has verified: by reference, or moved
+      // or copied into a value parameter, as the frame allows. The copies, if any, live
+      // in the `BoundArgument` temporaries until `do_work()` returns.
+      if constexpr (kIsCoroutine) {
+        adopt(m_person.do_work(BoundArgument<Args>(arguments, Is).get()...), task);
+      } else {
+        m_person.do_work(BoundArgument<Args>(arguments, Is).get()...);
+      }
+    }
+
+    // Has the coroutine that `do_work()` `started` own this holder too, so that its person
+    // outlives the `BasicAnyPerson`, if need be, then stores the coroutine in `*task`, or
+    // leaves it detached if `task` is nullptr.
+    void adopt(Library::WorkTask started, Library::WorkTask* task) noexcept {
+      m_owners.fetch_add(1, std::memory_order_relaxed);
+      if (!started.keep_alive(this, &release_of)) {
+        release();
+      }
+      if (task != nullptr) {
+        *task = std::move(started);
+      }
+    }
+    static void release_of(void* holder) noexcept { static_cast<PersonHolder*>(holder)->release(); }
+
+    // Owners of a coroutine person's holder: its `BasicAnyPerson`, and each coroutine
+    // still running or awaited
+    struct NoOwners {
+      constexpr explicit NoOwners(std::size_t) noexcept {}
+    };
+    [[no_unique_address]] std::conditional_t<kIsCoroutine, std::atomic<std::size_t>, NoOwners> m_owners{1};
+
+    P m_person;
+  }; // struct PersonHolder
+} // namespace detail
+
+// Dispatch policies of `BasicAnyPerson`. Either one's `Handle` points to the
+// `detail::PersonHolder` and forwards calls to it; `holder == nullptr` means empty.
+
+// Calls the holder through its compiler-generated virtual table, which takes loading
+// the vtable pointer from the holder and then the function pointer from the vtable.
+struct VirtualDispatch {
+  class Handle {
+  public:
+    Handle() noexcept = default;
+    template<typename H>
+    explicit Handle(H* holder) noexcept : m_holder(holder) {}
+
+    [[nodiscard]] detail::IPersonHolder* holder() const noexcept { return m_holder; }
+    [[nodiscard]] Library::Name name() const noexcept { return m_holder->name(); }
+    [[nodiscard]] const detail::Signature& signature() const noexcept { return m_holder->signature(); }
+    [[nodiscard]] Library::WorkResult invoke_work(const detail::ArgFrameRef& arguments, Library::WorkTask* task) const {
+      return m_holder->invoke_work(arguments, task);
+    }
+    [[nodiscard]] Library::WorkResult invoke_work_batch(const detail::BatchRef& batch) const {
+      return m_holder->invoke_work_batch(batch);
+    }
+    [[nodiscard]] Library::WorkResult invoke_work_columns(const detail::ColumnsRef& columns) const {
+      return m_holder->invoke_work_columns(columns);
+    }
+    [[nodiscard]] Handle move_into(void* buffer) const { return Handle(m_holder->move_into(buffer)); }
+    // `in_buffer` tells whether the holder was constructed in place or allocated
+    void destroy(bool in_buffer) const noexcept {
+      if (in_buffer) {
+        m_holder->~IPersonHolder();
+      } else {
+        m_holder->release();
+      }
+    }
+
+  private:
+    detail::IPersonHolder* m_holder = nullptr;
+  };
+};
+
+// Keeps pointers to the holder's functions in `BasicAnyPerson` itself, next to the
+// pointer to the holder (Dyno or folly::Poly style), so that a call is a single indirect
+// call through memory that's already in cache. It makes `BasicAnyPerson` a pointer per
+// function bigger.
+struct InlineVTableDispatch {
+  class Handle {
+  public:
+    Handle() noexcept = default;
+    template<typename H>
+    explicit Handle(H* holder) noexcept
+      : m_holder(holder)
+      , m_name(&name_of<H>)
+      , m_signature(&signature_of<H>)
+      , m_invoke_work(&invoke_work_of<H>)
+      , m_invoke_work_batch(&invoke_work_batch_of<H>)
+      , m_invoke_work_columns(&invoke_work_columns_of<H>)
+      , m_move_into(&move_into_of<H>)
+      , m_destroy(&destroy_of<H>)
+    {}
+
+    [[nodiscard]] detail::IPersonHolder* holder() const noexcept { return m_holder; }
+    [[nodiscard]] Library::Name name() const noexcept { return m_name(m_holder); }
+    [[nodiscard]] const detail::Signature& signature() const noexcept { return m_signature(m_holder); }
+    [[nodiscard]] Library::WorkResult invoke_work(const detail::ArgFrameRef& arguments, Library::WorkTask* task) const {
+      return m_invoke_work(m_holder, arguments, task);
+    }
+    [[nodiscard]] Library::WorkResult invoke_work_batch(const detail::BatchRef& batch) const {
+      return m_invoke_work_batch(m_holder, batch);
+    }
+    [[nodiscard]] Library::WorkResult invoke_work_columns(const detail::ColumnsRef& columns) const {
+      return m_invoke_work_columns(m_holder, columns);
+    }
+    [[nodiscard]] Handle move_into(void* buffer) const {
+      Handle moved = *this;
+      moved.m_holder = m_move_into(m_holder, buffer);
+      return moved;
+    }
+    void destroy(bool in_buffer) const noexcept { m_destroy(m_holder, in_buffer); }
+
+  private:
+    // `H` is a final `detail::PersonHolder`, so these call its methods directly
+    template<typename H>
+    static Library::Name name_of(const detail::IPersonHolder* holder) noexcept {
+      return static_cast<const H*>(holder)->name();
+    }
+    template<typename H>
+    static const detail::Signature& signature_of(const detail::IPersonHolder* holder) noexcept {
+      return static_cast<const H*>(holder)->signature();
+    }
+    template<typename H>
+    static Library::WorkResult invoke_work_of(detail::IPersonHolder* holder, const detail::ArgFrameRef& arguments,
+                                              Library::WorkTask* task) {
+      return static_cast<H*>(holder)->invoke_work(arguments, task);
+    }
+    template<typename H>
+    static Library::WorkResult invoke_work_batch_of(detail::IPersonHolder* holder, const detail::BatchRef& batch) {
+      return static_cast<H*>(holder)->invoke_work_batch(batch);
+    }
+    template<typename H>
+    static Library::WorkResult invoke_work_columns_of(detail::IPersonHolder* holder, const detail::ColumnsRef& columns) {
+      return static_cast<H*>(holder)->invoke_work_columns(columns);
+    }
+    template<typename H>
+    static detail::IPersonHolder* move_into_of(detail::IPersonHolder* holder, void* buffer) {
+      return static_cast<H*>(holder)->move_into(buffer);
+    }
+    template<typename H>
+    static void destroy_of(detail::IPersonHolder* holder, bool in_buffer) noexcept {
+      if (in_buffer) {
+        static_cast<H*>(holder)->~H();
+      } else {
+        static_cast<H*>(holder)->release();
+      }
+    }
+
+    detail::IPersonHolder* m_holder = nullptr;
+    Library::Name            (*m_name)(const detail::IPersonHolder*) noexcept                                        = nullptr;
+    const detail::Signature& (*m_signature)(const detail::IPersonHolder*) noexcept                                   = nullptr;
+    Library::WorkResult      (*m_invoke_work)(detail::IPersonHolder*, const detail::ArgFrameRef&, Library::WorkTask*) = nullptr;
+    Library::WorkResult      (*m_invoke_work_batch)(detail::IPersonHolder*, const detail::BatchRef&)                 = nullptr;
+    Library::WorkResult      (*m_invoke_work_columns)(detail::IPersonHolder*, const detail::ColumnsRef&)             = nullptr;
+    detail::IPersonHolder*   (*m_move_into)(detail::IPersonHolder*, void*)                                           = nullptr;
+    void                     (*m_destroy)(detail::IPersonHolder*, bool) noexcept                                     = nullptr;
+  };
+};
+
+// Default size of the in-object buffer of `AnyPerson`. It fits the holder of a
+// `Library::Person` sub-class that has a name and a few more pointer-sized members.
+inline constexpr std::size_t kDefaultPersonBufferSize = 64;
+
+// `PersonHolder`s that fit into `BufferSize` bytes aligned on `BufferAlign` are
+// constructed right inside `BasicAnyPerson`; bigger ones are allocated on the heap, and
+// so are those of coroutine persons, which their coroutines may outlive the
+// `BasicAnyPerson` with (see `Library::WorkTask`).
+// `Dispatch` is `VirtualDispatch` or `InlineVTableDispatch`.
+template<typename    Dispatch    = VirtualDispatch,
+         std::size_t BufferSize  = kDefaultPersonBufferSize,
+         std::size_t BufferAlign = alignof(std::max_align_t)>
+class BasicAnyPerson {
+public:
+  template<typename P,
+           typename = std::enable_if_t<std::is_base_of_v<Library::Person, std::decay_t<P>>>>
+  BasicAnyPerson(P&& person)
+    : m_holder(make_holder(std::forward<P>(person), &std::decay_t<P>::do_work))
+  {}
+
+  // Moving an inline holder moves the `Library::Person` it contains, which may throw.
+  BasicAnyPerson(BasicAnyPerson&& other) : m_holder(other.steal_holder(m_buffer)) {}
+  BasicAnyPerson& operator=(BasicAnyPerson&& other) {
+    if (this != &other) {
+      destroy_holder();
+      m_holder = other.steal_holder(m_buffer);
+    }
+    return *this;
+  }
+  BasicAnyPerson(const BasicAnyPerson&)            = delete;
+  BasicAnyPerson& operator=(const BasicAnyPerson&) = delete;
+  ~BasicAnyPerson() { destroy_holder(); }
+
+  [[nodiscard]] Library::Name name() const noexcept { return m_holder.name(); }
+
+  // Throws `Library::BadWorkArguments` (or aborts, if exceptions are disabled) when
+  // the arguments don't match the parameters of `do_work()`. Returns the work in
+  // progress if `do_work()` is a coroutine, or an empty (ready) task otherwise.
+  // What `do_work()` prints is a record of its own, unless the caller, such as
+  // `Library::Office::work()`, has one in progress.
+  template<typename... Args>
+  Library::WorkTask work(Args&&... arguments) {
+    const Library::OutputRecord record;
+    Library::WorkTask task;
+    const detail::SyncFrame<Args...> frame(std::forward<Args>(arguments)...);
+    if (const Library::WorkResult result = m_holder.invoke_work(frame.ref(), &task); !result) {
+      detail::raise_work_error(result);
+    }
+    return task;
+  }
+
+  // Like `work()`, but returns mismatched arguments as an error rather than throwing.
+  // A coroutine `do_work()` is left running detached.
+  template<typename... Args>
+  [[nodiscard]] Library::WorkResult try_work(Args&&... arguments) {
+    Library::OutputRecord record;
+    const detail::SyncFrame<Args...> frame(std::forward<Args>(arguments)...);
+    const Library::WorkResult result = m_holder.invoke_work(frame.ref(), nullptr);
+    if (!result) {
+      record.drop();
+    }
+    return result;
+  }
+
+  // Like `try_work()`, with the arguments already in a frame, such as the one that
+  // `Office::submit_work()` queues.
+  [[nodiscard]] Library::WorkResult try_work_frame(const detail::ArgFrameRef& arguments,
+                                                   Library::WorkTask* task = nullptr) {
+    return m_holder.invoke_work(arguments, task);
+  }
+
+  // Calls `do_work()` with each of `items`, crossing the type erasure and checking the
+  // argument types once for the whole batch. The items are passed by const reference,
+  // so `do_work()` has to take its parameters by value or const reference.
+  template<typename... Args>
+  void work_batch(std::span<const std::tuple<Args...>> items) {
+    if (const Library::WorkResult result = try_work_batch(items); !result) {
+      detail::raise_work_error(result);
+    }
+  }
+  template<typename... Args>
+  void work_batch(std::span<std::tuple<Args...>> items) { work_batch(std::span<const std::tuple<Args...>>(items)); }
+
+  template<typename... Args>
+  [[nodiscard]] Library::WorkResult try_work_batch(std::span<const std::tuple<Args...>> items) {
+    static_assert((std::is_same_v<Args, std::decay_t<Args>> && ...), "batch items must hold values");
+    Library::OutputRecord record;
+    const Library::WorkResult result =
+      m_holder.invoke_work_batch({&detail::signature_of<Args...>, items.data(), items.size()});
+    if (!result) {
+      record.drop();
+    }
+    return result;
+  }
+  template<typename... Args>
+  [[nodiscard]] Library::WorkResult try_work_batch(std::span<std::tuple<Args...>> items) {
+    return try_work_batch(std::span<const std::tuple<Args...>>(items));
+  }
+
+  // Calls `do_work_bulk()` with the whole columns, if the person has one, or `do_work()`
+  // with each row. Either way, the types are checked once for all the rows.
+  template<typename... Args>
+  void work_columns(const Library::Columns<Args...>& columns) {
+    if (const Library::WorkResult result = try_work_columns(columns); !result) {
+      detail::raise_work_error(result);
+    }
+  }
+
+  template<typename... Args>
+  [[nodiscard]] Library::WorkResult try_work_columns(const Library::Columns<Args...>& columns) {
+    Library::OutputRecord record;
+    const Library::WorkResult result = try_work_columns_impl(columns, std::index_sequence_for<Args...>());
+    if (!result) {
+      record.drop();
+    }
+    return result;
+  }
+
+  // Checks whether `work()` would accept arguments of types `Args` without calling it.
+  template<typename... Args>
+  [[nodiscard]] Library::WorkResult check_work() const noexcept {
+    return detail::check_arguments(m_holder.signature(),
+                                   detail::signature_of<std::decay_t<Args>...>);
+  }
+
+  // True if the person is stored in the object itself rather than on the heap.
+  [[nodiscard]] bool is_inline() const noexcept { return m_holder.holder() == static_cast<const void*>(m_buffer); }
+
+private:
+  using Handle = typename Dispatch::Handle;
+
+  template<typename... Args, std::size_t... Is>
+  Library::WorkResult try_work_columns_impl(const Library::Columns<Args...>& columns, std::index_sequence<Is...>) {
+    const std::array<const void*, sizeof...(Args)> data{{columns.template column<Is>().data()...}};
+    return m_holder.invoke_work_columns({&detail::signature_of<Args...>, data.data(), columns.size()});
+  }
+
+  template<typename H>
+  static constexpr bool fits_inline = sizeof(H) <= BufferSize && alignof(H) <= BufferAlign;
+
+private:
+  // `do_work()` returns `void`, or `Library::WorkTask` if it's a coroutine, whose holder
+  // stays on the heap, where the coroutines it starts share it.
+  template<typename P, typename R, typename... Args>
+  Handle make_holder(P&& person, R(std::decay_t<P>::*)(Args...)) {
+    static_assert(std::is_void_v<R> || std::is_same_v<R, Library::WorkTask>,
+                  "do_work() must return void or Library::WorkTask");
+    using Holder = detail::PersonHolder<std::decay_t<P>, Args...>;
+    if constexpr (fits_inline<Holder> && std::is_void_v<R>) {
+      return Handle(::new (static_cast<void*>(m_buffer)) Holder(std::forward<P>(person)));
+    } else {
+      return Handle(new Holder(std::forward<P>(person)));
+    }
+  }
+
+  // Hands the holder over to another `BasicAnyPerson`, whose buffer is `buffer`,
+  // leaving this one empty.
+  Handle steal_holder(void* buffer) {
+    Handle handle = m_holder;
+    if (handle.holder() != nullptr && is_inline()) {
+      handle = m_holder.move_into(buffer);
+      destroy_holder();
+    }
+    m_holder = Handle();
+    return handle;
+  }
+
+  void destroy_holder() noexcept {
+    if (m_holder.holder() != nullptr) {
+      m_holder.destroy(is_inline());
+    }
+    m_holder = Handle();
+  }
+
+  alignas(BufferAlign) unsigned char m_buffer[BufferSize > 0 ? BufferSize : 1];
+  Handle m_holder;
+}; // class BasicAnyPerson
+
+using AnyPerson = BasicAnyPerson<>;
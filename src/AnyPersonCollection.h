@@ -0,0 +1,167 @@
+#pragma once
+
+#include "ArgFrame.h"
+#include "Office.h"
+#include "Output.h"
+#include "TypeId.h"
+#include "WorkErrors.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace Library {
+
+// A heterogeneous collection of `Library::Person`s that, unlike `std::vector<AnyPerson>`,
+// stores the persons of each concrete type contiguously, in a segment of their own.
+// `for_each_work()` walks the collection segment by segment, so that within a segment
+// `do_work()` is called directly rather than through a type-erased holder, and the
+// (one) indirect call per segment is trivially predicted. The order of the persons is
+// only kept within a segment.
+class AnyPersonCollection {
+public:
+  // Adds `person` to the segment of its type. The reference stays valid until the next
+  // insertion into or erasure from that segment. Its `do_work()` must return `void`, and
+  // take its parameters by const reference or by copyable value (see `for_each_work()`).
+  template<typename P,
+           typename = std::enable_if_t<std::is_base_of_v<Person, std::decay_t<P>>>>
+  std::decay_t<P>& insert(P&& person) {
+    using Type = std::decay_t<P>;
+    return segment_for<Type>(&Type::do_work).m_persons.emplace_back(std::forward<P>(person));
+  }
+
+  // Removes the persons for which `pred(const Person&)` is true; returns their number.
+  template<typename Pred>
+  std::size_t erase_if(Pred pred) {
+    std::size_t erased = 0;
+    for (const auto& segment : m_segments) {
+      erased += segment->erase_if([](const void* p, const Person& person) {
+        return (*static_cast<const Pred*>(p))(person);
+      }, &pred);
+    }
+    return erased;
+  }
+
+  // Has every person whose `do_work()` accepts `arguments` work on them and returns
+  // the number of those persons; the others are skipped. The arguments are passed by
+  // const reference, since they're shared by all the persons, so a parameter taken by
+  // value is a copy: persons that take a move-only one by value, or a non-const
+  // reference, can't be inserted, and nor can coroutine persons, whose work would
+  // outlive the call. Prints a line per person like `Library::Office::work()`.
+  template<typename... Args>
+  std::size_t for_each_work(Args&&... arguments) {
+    const detail::SyncFrame<const std::decay_t<Args>&...> frame(arguments...);
+    const detail::ArgFrameRef ref = frame.ref();
+    std::size_t worked = 0;
+    for (const auto& segment : m_segments) {
+      worked += segment->work_all(ref);
+    }
+    return worked;
+  }
+
+  [[nodiscard]] std::size_t size() const noexcept {
+    std::size_t size = 0;
+    for (const auto& segment : m_segments) {
+      size += segment->size();
+    }
+    return size;
+  }
+  [[nodiscard]] bool empty() const noexcept { return size() == 0; }
+  // Number of distinct person types that have been inserted
+  [[nodiscard]] std::size_t segment_count() const noexcept { return m_segments.size(); }
+
+private:
+  struct ISegment {
+    virtual ~ISegment() = default;
+    [[nodiscard]] virtual std::size_t size() const noexcept = 0;
+    virtual std::size_t work_all(const detail::ArgFrameRef& arguments) = 0;
+    virtual std::size_t erase_if(bool (*pred)(const void*, const Person&), const void* context) = 0;
+  };
+
+  template<typename P, typename... Params>
+  struct Segment final : public ISegment {
+    [[nodiscard]] std::size_t size() const noexcept override { return m_persons.size(); }
+
+    std::size_t work_all([[maybe_unused]] const detail::ArgFrameRef& arguments) override {
+      if (detail::check_arguments(kSignature, arguments.signature())) {
+        work_all_impl(arguments, std::index_sequence_for<Params...>());
+        return m_persons.size();
+      }
+      return 0;
+    }
+
+    std::size_t erase_if(bool (*pred)(const void*, const Person&), const void* context) override {
+      const std::size_t size = m_persons.size();
+      if constexpr (std::is_move_assignable_v<P>) {
+        std::erase_if(m_persons, [pred, context](const P& person) { return pred(context, person); });
+      } else {
+        std::vector<P> kept;
+        kept.reserve(size);
+        for (P& person : m_persons) {
+          if (!pred(context, person)) {
+            kept.push_back(std::move(person));
+          }
+        }
+        m_persons = std::move(kept);
+      }
+      return size - m_persons.size();
+    }
+
+    static constexpr const detail::Signature& kSignature = detail::signature_of<std::decay_t<Params>...>;
+
+    // The arguments are copied in a `PackedFrame` if they're packable, and referred to
+    // otherwise (see `detail::SyncFrame`).
+    template<std::size_t... Is>
+    void work_all_impl(const detail::ArgFrameRef& arguments, std::index_sequence<Is...>) {
+      using Layout = detail::PackedLayout<std::decay_t<Params>...>;
+      if constexpr (Layout::packable) {
+        if (std::byte* const bytes = arguments.packed()) {
+          work_each(std::as_const(Layout::template get<Is>(bytes))...);
+          return;
+        }
+      }
+      work_each(std::as_const(arguments.get<std::decay_t<Params>>(Is))...);
+    }
+
+    void work_each(const std::decay_t<Params>&... arguments) {
+      for (P& person : m_persons) {
+        const OutputRecord record;
+        out() << person.name() << static_text<" is working on ">;
+        person.do_work(arguments...);
+      }
+    }
+
+    std::vector<P> m_persons;
+  }; // struct Segment
+
+  template<typename P, typename R, typename... Params>
+  Segment<P, Params...>& segment_for(R (P::*)(Params...)) {
+    static_assert(!std::is_same_v<R, WorkTask>,
+                  "AnyPersonCollection can't hold coroutine persons, whose work would outlive the "
+                  "for_each_work() call: use an Office or AnyPerson");
+    static_assert(std::is_void_v<R> || std::is_same_v<R, WorkTask>, "do_work() must return void");
+    static_assert(std::is_invocable_v<R (P::*)(Params...), P&, const std::decay_t<Params>&...>,
+                  "for_each_work() shares its arguments among the persons, by const reference, so "
+                  "do_work() can't take a move-only parameter by value or a non-const reference");
+    using S = Segment<P, Params...>;
+    ISegment*& segment = m_index[type_id<P>()];
+    if (segment == nullptr) {
+      segment = m_segments.emplace_back(std::make_unique<S>()).get();
+    }
+    return static_cast<S&>(*segment);
+  }
+
+  struct TypeIdHash {
+    std::size_t operator()(TypeId id) const noexcept { return std::hash<const void*>{}(id.value); }
+  };
+
+  std::vector<std::unique_ptr<ISegment>>             m_segments; // in order of first insertion
+  std::unordered_map<TypeId, ISegment*, TypeIdHash> m_index;
+};
+
+} // namespace Library
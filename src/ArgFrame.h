@@ -0,0 +1,342 @@
+#pragma once
+
+#include "TypeId.h"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <initializer_list>
+#include <memory>
+#include <new>
+#include <optional>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace detail {
+
+// The decayed types of the arguments of a `work()` call, or of the parameters of a
+// `do_work()` method. One instance per type list lives in static storage, so two
+// signatures are the same if they are at the same address.
+struct Signature {
+  std::uint64_t           fingerprint; // hash of the arity and `names`, for tracing only
+  std::size_t             arity;
+  const Library::TypeId*  types;
+  const std::string_view* names;       // only used to describe mismatches
+};
+
+// Types spelled alike get the same fingerprint, so it tells signatures apart in traces
+// and logs, but doesn't identify them.
+constexpr std::uint64_t fingerprint_of(const std::string_view* names, std::size_t arity) noexcept {
+  std::uint64_t hash = 14695981039346656037ull ^ arity;
+  for (std::size_t i = 0; i < arity; ++i) {
+    hash = (hash ^ fnv1a(names[i])) * 1099511628211ull;
+    hash ^= hash >> 29;
+  }
+  return hash;
+}
+
+template<typename... Args>
+struct SignatureOf {
+  static constexpr std::array<Library::TypeId, sizeof...(Args)>  types{{Library::type_id<Args>()...}};
+  static constexpr std::array<std::string_view, sizeof...(Args)> names{{Library::type_name<Args>()...}};
+  static constexpr Signature value{fingerprint_of(names.data(), sizeof...(Args)),
+                                   sizeof...(Args), types.data(), names.data()};
+};
+
+template<typename... Args>
+inline constexpr const Signature& signature_of = SignatureOf<Args...>::value;
+
+// Type-erased view of an `ArgFrame`, an `ArgRefFrame` or a `PackedFrame`, which is what
+// gets passed through the virtual `IPersonHolder::invoke_work()`. It doesn't own the
+// arguments, and tells, for each one, whether `do_work()` may modify it and whether it
+// may move from it.
+class ArgFrameRef {
+public:
+  static constexpr std::size_t kMaxArity = 64;
+
+  ArgFrameRef(const Signature& signature, void* const* objects,
+              std::uint64_t writable = ~std::uint64_t{0}, std::uint64_t movable = ~std::uint64_t{0}) noexcept
+    : m_signature(&signature), m_objects(objects), m_writable(writable), m_movable(movable) {}
+
+  // A `PackedFrame`, whose arguments are copies at the offsets of `PackedLayout`
+  [[nodiscard]] static ArgFrameRef packed(const Signature& signature, std::byte* bytes) noexcept {
+    ArgFrameRef ref(signature, nullptr);
+    ref.m_packed = bytes;
+    return ref;
+  }
+
+  [[nodiscard]] const Signature& signature() const noexcept { return *m_signature; }
+  [[nodiscard]] std::size_t size() const noexcept { return m_signature->arity; }
+
+  // The bytes of a `PackedFrame`, or nullptr
+  [[nodiscard]] std::byte* packed() const noexcept { return m_packed; }
+
+  // Returns the argument at `index` without checking its type: compare the whole
+  // signature first. It must not be modified unless
+  // `writable(index)`, nor moved from unless `movable(index)`.
+  template<typename T>
+  [[nodiscard]] T& get(std::size_t index) const noexcept { return *static_cast<T*>(m_objects[index]); }
+
+  [[nodiscard]] bool writable(std::size_t index) const noexcept { return (m_writable >> index) & 1; }
+  [[nodiscard]] bool movable(std::size_t index) const noexcept { return (m_movable >> index) & 1; }
+
+private:
+  const Signature* m_signature;
+  void* const*     m_objects;
+  std::uint64_t    m_writable; // bit i for argument i
+  std::uint64_t    m_movable;
+  std::byte*       m_packed = nullptr;
+};
+
+// Binds the argument at `index` of a frame to a `do_work()` parameter of type `Param`:
+// a const reference parameter refers to the argument itself, and so does a non-const
+// one if the argument is writable; a value or rvalue reference parameter gets the
+// argument moved if it's movable. Otherwise, the parameter gets a copy of the argument,
+// which `bindable()` tells if possible.
+template<typename Param>
+class BoundArgument {
+public:
+  using T = std::decay_t<Param>;
+
+  [[nodiscard]] static bool bindable(const ArgFrameRef& arguments, std::size_t index) noexcept {
+    if constexpr (kByConstReference || std::is_copy_constructible_v<T>) {
+      return true;
+    } else if constexpr (std::is_lvalue_reference_v<Param>) {
+      return arguments.writable(index);
+    } else {
+      return arguments.movable(index);
+    }
+  }
+
+  BoundArgument(const ArgFrameRef& arguments, std::size_t index) noexcept
+    : m_object(arguments.get<T>(index)), m_writable(arguments.writable(index)), m_movable(arguments.movable(index)) {}
+  BoundArgument(const BoundArgument&)            = delete;
+  BoundArgument& operator=(const BoundArgument&) = delete;
+
+  // Called once, after `bindable()`.
+  Param get() {
+    if constexpr (kByConstReference) {
+      return static_cast<Param>(m_object);
+    } else if constexpr (std::is_lvalue_reference_v<Param>) {
+      return m_writable ? m_object : copy();
+    } else if constexpr (std::is_rvalue_reference_v<Param>) {
+      return m_movable ? std::move(m_object) : std::move(copy());
+    } else if (m_movable) {
+      return std::move(m_object);
+    } else {
+      if constexpr (std::is_copy_constructible_v<T>) {
+        return m_object;
+      } else {
+        std::abort(); // ruled out by `bindable()`
+      }
+    }
+  }
+
+private:
+  static constexpr bool kByConstReference =
+    std::is_reference_v<Param> && std::is_const_v<std::remove_reference_t<Param>>;
+  static constexpr bool kMayCopy = std::is_reference_v<Param> && !kByConstReference;
+
+  T& copy() {
+    if constexpr (std::is_copy_constructible_v<T>) {
+      return m_copy.emplace(std::as_const(m_object));
+    } else {
+      std::abort(); // ruled out by `bindable()`
+    }
+  }
+
+  struct NoCopy {};
+
+  T&                                                     m_object;
+  bool                                                   m_writable;
+  bool                                                   m_movable;
+  [[no_unique_address]] std::conditional_t<kMayCopy, std::optional<T>, NoCopy> m_copy;
+};
+
+// Type-erased view of the items of `AnyPerson::work_batch()`: `count` consecutive
+// `std::tuple`s of the types in `signature`.
+struct BatchRef {
+  const Signature* signature;
+  const void*      items;
+  std::size_t      count;
+};
+
+// Type-erased view of `Library::Columns` for `AnyPerson::work_columns()`: a pointer to
+// the first element of each column, of the types in `signature`, `count` elements long.
+struct ColumnsRef {
+  const Signature*   signature;
+  const void* const* columns;
+  std::size_t        count;
+};
+
+// Holds copies of the arguments of a call that outlives them, such as the queued work
+// of `Office::submit_work()`. `Args` are decayed types; the frame owns its copies, which
+// `do_work()` may modify or move from.
+template<typename... Args>
+class ArgFrame {
+public:
+  template<typename... T>
+  explicit ArgFrame(T&&... arguments)
+    : m_values(std::forward<T>(arguments)...)
+    , m_objects(make_objects(std::index_sequence_for<Args...>()))
+  {}
+
+  // `m_objects` point into `m_values`, so the frame stays where it was constructed.
+  ArgFrame(const ArgFrame&)            = delete;
+  ArgFrame& operator=(const ArgFrame&) = delete;
+
+  [[nodiscard]] ArgFrameRef ref() noexcept { return {signature_of<Args...>, m_objects.data()}; }
+
+private:
+  template<std::size_t... Is>
+  std::array<void*, sizeof...(Args)> make_objects(std::index_sequence<Is...>) noexcept {
+    return {{&std::get<Is>(m_values)...}};
+  }
+
+  std::tuple<Args...>                m_values;
+  std::array<void*, sizeof...(Args)> m_objects;
+};
+
+// Where the arguments of types `Args` (decayed, trivially copyable) go in a `PackedFrame`:
+// one after the other, each aligned, except that empty types take no room at all. Both
+// the caller and `PersonHolder` compute it from the types, which the signature check
+// has found identical.
+template<typename... Args>
+struct PackedLayout {
+  static constexpr std::size_t kMaxSize = 64;
+
+  template<typename T>
+  static constexpr bool kTakesNoRoom = std::is_empty_v<T> && std::is_trivially_default_constructible_v<T>;
+
+  static constexpr std::size_t alignment = std::max({std::size_t{1}, alignof(Args)...});
+
+  static constexpr auto compute() noexcept {
+    std::array<std::size_t, sizeof...(Args) + 1> result{}; // the offsets, then the size
+    std::size_t offset = 0;
+    std::size_t i = 0;
+    [[maybe_unused]] const auto place = [&](std::size_t size, std::size_t align, bool takes_no_room) {
+      if (takes_no_room) {
+        result[i++] = 0;
+        return;
+      }
+      offset = (offset + align - 1) / align * align;
+      result[i++] = offset;
+      offset += size;
+    };
+    (place(sizeof(Args), alignof(Args), kTakesNoRoom<Args>), ...);
+    result[i] = offset;
+    return result;
+  }
+  static constexpr auto offsets = compute();
+  static constexpr std::size_t size = offsets[sizeof...(Args)];
+
+  // Whether arguments of types `Args` are passed in a `PackedFrame`
+  static constexpr bool packable = (std::is_trivially_copyable_v<Args> && ...) && size <= kMaxSize;
+
+  // The argument at `I` in the frame at `bytes`, which `memcpy()` created there
+  template<std::size_t I>
+  static auto& get(std::byte* bytes) noexcept {
+    using T = std::tuple_element_t<I, std::tuple<Args...>>;
+    if constexpr (kTakesNoRoom<T>) {
+      static T empty{}; // stateless: any instance will do
+      return empty;
+    } else {
+      return *std::launder(reinterpret_cast<T*>(bytes + offsets[I]));
+    }
+  }
+};
+
+// Holds copies of small, trivially copyable arguments of a synchronous call, such as
+// the empty `Monitor`, `Keyboard` and `Cup`, packed in raw bytes with `memcpy()`, so
+// that `PersonHolder` reads them back with no constructor, destructor, nor pointer per
+// argument. `Args` are decayed types.
+template<typename... Args>
+class PackedFrame {
+public:
+  using Layout = PackedLayout<Args...>;
+  static_assert(Layout::packable);
+
+  explicit PackedFrame(const Args&... arguments) noexcept {
+    store(std::index_sequence_for<Args...>(), arguments...);
+  }
+
+  // `ref()` points into the frame, so it stays where it was constructed.
+  PackedFrame(const PackedFrame&)            = delete;
+  PackedFrame& operator=(const PackedFrame&) = delete;
+
+  [[nodiscard]] ArgFrameRef ref() const noexcept {
+    return ArgFrameRef::packed(signature_of<Args...>, const_cast<std::byte*>(m_bytes));
+  }
+
+private:
+  template<std::size_t... Is>
+  void store(std::index_sequence<Is...>, const Args&... arguments) noexcept {
+    ((Layout::template kTakesNoRoom<Args> ? void()
+                                          : void(std::memcpy(m_bytes + Layout::offsets[Is],
+                                                             std::addressof(arguments), sizeof(Args)))), ...);
+  }
+
+  alignas(Layout::alignment) std::byte m_bytes[Layout::size > 0 ? Layout::size : 1];
+};
+
+// Refers to the arguments of a synchronous call where the caller has them, on the
+// caller's stack, so that passing them to `PersonHolder` neither allocates nor copies:
+// `do_work()` gets a reference straight to the caller's object if it takes one, and
+// otherwise the argument moved if it's an rvalue, or copied. `Args` are the types
+// deduced for forwarding references (`X&` for lvalues, `X` for rvalues).
+template<typename... Args>
+class ArgRefFrame {
+public:
+  static_assert(sizeof...(Args) <= ArgFrameRef::kMaxArity);
+
+  explicit ArgRefFrame(Args&&... arguments) noexcept
+    : m_objects{{const_cast<void*>(static_cast<const void*>(std::addressof(arguments)))...}}
+  {}
+
+  // `m_objects` point into the caller's arguments, so the frame lives no longer.
+  ArgRefFrame(const ArgRefFrame&)            = delete;
+  ArgRefFrame& operator=(const ArgRefFrame&) = delete;
+
+  [[nodiscard]] ArgFrameRef ref() const noexcept {
+    return {signature_of<std::decay_t<Args>...>, m_objects.data(), kWritable, kMovable};
+  }
+
+private:
+  template<typename T>
+  static constexpr bool kIsWritable = !std::is_const_v<std::remove_reference_t<T>>;
+  template<typename T>
+  static constexpr bool kIsMovable = kIsWritable<T> && !std::is_lvalue_reference_v<T>;
+
+  static constexpr std::uint64_t mask(std::initializer_list<bool> bits) noexcept {
+    std::uint64_t result = 0;
+    for (std::size_t i = 0; const bool bit : bits) {
+      result |= std::uint64_t{bit} << i++;
+    }
+    return result;
+  }
+
+  static constexpr std::uint64_t kWritable = mask({kIsWritable<Args>...});
+  static constexpr std::uint64_t kMovable  = mask({kIsMovable<Args>...});
+
+  std::array<void*, sizeof...(Args)> m_objects;
+};
+
+// Whether the arguments of a synchronous call, of types deduced for forwarding
+// references, go in a `PackedFrame`: they must be packable, and none a non-const lvalue,
+// which `do_work()` may take by reference to modify it.
+template<typename... Args>
+inline constexpr bool kPassPacked =
+  PackedLayout<std::decay_t<Args>...>::packable
+  && ((!std::is_lvalue_reference_v<Args> || std::is_const_v<std::remove_reference_t<Args>>) && ...);
+
+// The frame of a synchronous call with arguments of types `Args`, deduced for forwarding
+// references
+template<typename... Args>
+using SyncFrame = std::conditional_t<kPassPacked<Args...>, PackedFrame<std::decay_t<Args>...>, ArgRefFrame<Args...>>;
+
+} // namespace detail
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "BinaryRecords.h"
+#include "Output.h"
+
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Library {
+
+// While a `BinaryLog` is alive, the records written through `out()` are stored in binary
+// form, with no formatting, in a lock-free ring per thread (see `detail::RecordRing`), and
+// its own thread renders them as text and commits them to `sink`, in batches. The calling
+// threads then only copy values; they wait only if their ring fills up faster than the
+// log renders it. Records of one thread keep their order, even one too big for its ring,
+// which its thread renders and commits itself once the log has committed those before
+// it; records of different threads are only ordered within a batch per thread.
+//
+// Records are less compact than NanoLog's, which are a format id and the raw arguments:
+// a record has no format of its own, only an id per name or `static_text` and a tagged
+// value per argument (see BinaryRecords.h).
+//
+// There may be one `BinaryLog` at a time, and it must outlive the work that writes to it.
+class BinaryLog {
+public:
+  explicit BinaryLog(OutputSink& sink, std::chrono::microseconds poll_interval = std::chrono::milliseconds(1))
+    : m_sink(sink), m_poll_interval(poll_interval) {
+    flush_output();
+    [[maybe_unused]] OutputSink* previous =
+      detail::OutputSettings::instance().binary_sink.exchange(&sink, std::memory_order_acq_rel);
+    assert(previous == nullptr && "only one BinaryLog at a time");
+    m_thread = std::thread([this] { run(); });
+  }
+  BinaryLog(const BinaryLog&)            = delete;
+  BinaryLog& operator=(const BinaryLog&) = delete;
+
+  // Renders the records written so far, then stops.
+  ~BinaryLog() {
+    detail::OutputSettings::instance().binary_sink.store(nullptr, std::memory_order_release);
+    m_stopping.store(true, std::memory_order_release);
+    m_thread.join();
+  }
+
+  // Waits until the records written so far, by any thread, are committed to the sink.
+  void sync() const {
+    const std::uint64_t pass = m_passes.load(std::memory_order_acquire);
+    // The pass under way may have missed them; the next one doesn't.
+    while (m_passes.load(std::memory_order_acquire) < pass + 2) {
+      std::this_thread::yield();
+    }
+  }
+
+private:
+  void run() {
+    std::vector<std::shared_ptr<detail::RecordRing>> rings;
+    std::uint64_t generation = 0;
+    std::string batch;
+    for (;;) {
+      const bool stopping = m_stopping.load(std::memory_order_acquire);
+      detail::RecordRings::instance().update(rings, generation);
+      std::size_t rendered = 0;
+      for (const auto& ring : rings) {
+        rendered += ring->drain([&](std::string_view record) { detail::render_record(record, batch); });
+        if (batch.size() >= kBatchBytes) {
+          m_sink.commit(batch);
+          batch.clear();
+        }
+      }
+      if (!batch.empty()) {
+        m_sink.commit(batch);
+        batch.clear();
+      }
+      for (const auto& ring : rings) {
+        ring->mark_committed();
+      }
+      m_passes.fetch_add(1, std::memory_order_release);
+      if (stopping) {
+        return; // after a last pass, as no record is written once the log is stopping
+      }
+      if (rendered == 0) {
+        std::this_thread::sleep_for(m_poll_interval);
+      }
+    }
+  }
+
+  static constexpr std::size_t kBatchBytes = 64 * 1024;
+
+  OutputSink&                m_sink;
+  std::chrono::microseconds  m_poll_interval;
+  std::atomic<bool>          m_stopping{false};
+  std::atomic<std::uint64_t> m_passes{0};
+  std::thread                m_thread;
+};
+
+} // namespace Library
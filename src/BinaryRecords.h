@@ -0,0 +1,263 @@
+#pragma once
+
+// The binary form of output records, for `Library::BinaryLog`. A record is the sequence
+// of values written to `Library::out()`, each a one-byte tag, which tells its type,
+// followed by its raw bytes: integers and floating-point numbers are copied, not
+// formatted, names and `Library::static_text`s, such as the " is " and "working on " that
+// `Office` writes, are stored as their 4-byte id in a `NameTable`, and other text is
+// copied with its length. The record is rendered as text later, by `render_record()`.
+//
+// This is less compact than NanoLog's records, which store the id of the whole format
+// string of a log statement and then only its arguments: a record here has no format
+// of its own, as it's assembled from the pieces that `Office`, the holder and
+// `do_work()` write, so it takes an id per static piece, and a tag per value.
+
+#include "Names.h"
+
+#include <atomic>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace detail {
+
+enum class FragmentTag : std::uint8_t {
+  Text,     // std::uint32_t length, then the characters
+  Char,     // char
+  Signed,   // std::int64_t
+  Unsigned, // std::uint64_t
+  Double,   // double
+  Name,     // std::uint32_t id of a `Library::Name`
+  Static,   // std::uint32_t id of a `StaticTextName`
+};
+
+// The table of the `Library::static_text`s that records refer to by id
+using StaticTextName = Library::InternedName<struct StaticTextKind>;
+
+template<typename T>
+void append_raw(std::string& record, T value) {
+  static_assert(std::is_trivially_copyable_v<T>);
+  char bytes[sizeof(T)];
+  std::memcpy(bytes, &value, sizeof(T));
+  record.append(bytes, sizeof(T));
+}
+
+template<typename T>
+void append_fragment(std::string& record, FragmentTag tag, T value) {
+  record.push_back(static_cast<char>(tag));
+  append_raw(record, value);
+}
+
+inline void append_text(std::string& record, std::string_view text) {
+  record.push_back(static_cast<char>(FragmentTag::Text));
+  append_raw(record, static_cast<std::uint32_t>(text.size()));
+  record.append(text);
+}
+
+template<typename T>
+T read_raw(std::string_view& bytes) noexcept {
+  T value;
+  std::memcpy(&value, bytes.data(), sizeof(T));
+  bytes.remove_prefix(sizeof(T));
+  return value;
+}
+
+// Appends the text of `record` to `text`, ending with a newline.
+inline void render_record(std::string_view record, std::string& text) {
+  const std::size_t start = text.size();
+  char digits[32];
+  const auto append_number = [&](auto value) {
+    const std::to_chars_result result = std::to_chars(digits, digits + sizeof(digits), value);
+    text.append(digits, result.ptr);
+  };
+  while (!record.empty()) {
+    const auto tag = static_cast<FragmentTag>(record.front());
+    record.remove_prefix(1);
+    switch (tag) {
+      case FragmentTag::Text: {
+        const auto length = read_raw<std::uint32_t>(record);
+        text.append(record.substr(0, length));
+        record.remove_prefix(length);
+        break;
+      }
+      case FragmentTag::Char:
+        text.push_back(read_raw<char>(record));
+        break;
+      case FragmentTag::Signed:
+        append_number(read_raw<std::int64_t>(record));
+        break;
+      case FragmentTag::Unsigned:
+        append_number(read_raw<std::uint64_t>(record));
+        break;
+      case FragmentTag::Double:
+        append_number(read_raw<double>(record));
+        break;
+      case FragmentTag::Name:
+        text.append(Library::Name::from_id(read_raw<std::uint32_t>(record)).view());
+        break;
+      case FragmentTag::Static:
+        text.append(StaticTextName::from_id(read_raw<std::uint32_t>(record)).view());
+        break;
+    }
+  }
+  if (text.size() == start || text.back() != '\n') {
+    text.push_back('\n');
+  }
+}
+
+// Single-producer, single-consumer ring of variable-size records, each stored
+// contiguously after its 32-bit length. A record that wouldn't fit before the end of
+// the ring starts over at its beginning, after a wrap marker.
+class RecordRing {
+public:
+  explicit RecordRing(std::size_t capacity = std::size_t{1} << 20)
+    : m_mask(capacity - 1), m_bytes(std::make_unique<char[]>(capacity)) {}
+  RecordRing(const RecordRing&)            = delete;
+  RecordRing& operator=(const RecordRing&) = delete;
+
+  [[nodiscard]] std::size_t capacity() const noexcept { return m_mask + 1; }
+
+  // Whether a record of `size` bytes fits once the ring is drained, wherever its tail is:
+  // one that doesn't fit before the end of the ring wastes the bytes it skips, so it may
+  // take up to twice its room.
+  [[nodiscard]] bool fits(std::size_t size) const noexcept {
+    return sizeof(std::uint32_t) + size <= capacity() / 2;
+  }
+
+  // Producer only; fails if the consumer hasn't made room for `record` yet, and always
+  // if it doesn't `fit()`.
+  bool try_push(std::string_view record) noexcept {
+    if (!fits(record.size())) {
+      return false;
+    }
+    std::uint64_t tail = m_tail.load(std::memory_order_relaxed);
+    const std::uint64_t head = m_head.load(std::memory_order_acquire);
+    const std::size_t needed = sizeof(std::uint32_t) + record.size();
+    std::size_t offset = tail & m_mask;
+    const std::size_t contiguous = capacity() - offset;
+    const std::size_t skipped = contiguous < needed ? contiguous : 0;
+    if (tail + skipped + needed - head > capacity()) {
+      return false;
+    }
+    if (skipped != 0) {
+      if (contiguous >= sizeof(std::uint32_t)) {
+        write_length(offset, kWrap);
+      }
+      tail += skipped;
+      offset = 0;
+    }
+    write_length(offset, static_cast<std::uint32_t>(record.size()));
+    std::memcpy(&m_bytes[offset + sizeof(std::uint32_t)], record.data(), record.size());
+    m_tail.store(tail + needed, std::memory_order_release);
+    return true;
+  }
+
+  // Consumer only; calls `consume(std::string_view)` with each record pushed so far and
+  // returns their number.
+  template<typename F>
+  std::size_t drain(F&& consume) {
+    std::uint64_t head = m_head.load(std::memory_order_relaxed);
+    const std::uint64_t tail = m_tail.load(std::memory_order_acquire);
+    std::size_t count = 0;
+    while (head != tail) {
+      const std::size_t offset = head & m_mask;
+      const std::size_t contiguous = capacity() - offset;
+      std::uint32_t length = kWrap;
+      if (contiguous >= sizeof(std::uint32_t)) {
+        std::memcpy(&length, &m_bytes[offset], sizeof(length));
+      }
+      if (length == kWrap) {
+        head += contiguous;
+        continue;
+      }
+      consume(std::string_view(&m_bytes[offset + sizeof(std::uint32_t)], length));
+      head += sizeof(std::uint32_t) + length;
+      ++count;
+    }
+    m_head.store(head, std::memory_order_release);
+    return count;
+  }
+
+  [[nodiscard]] bool empty() const noexcept {
+    return m_head.load(std::memory_order_acquire) == m_tail.load(std::memory_order_acquire);
+  }
+
+  // Consumer only; tells that the records drained so far are in the sink, rather than
+  // only in a batch being rendered.
+  void mark_committed() noexcept {
+    m_committed.store(m_head.load(std::memory_order_relaxed), std::memory_order_release);
+  }
+
+  // Producer only; whether all the records pushed so far are in the sink.
+  [[nodiscard]] bool committed() const noexcept {
+    return m_committed.load(std::memory_order_acquire) == m_tail.load(std::memory_order_relaxed);
+  }
+
+private:
+  static constexpr std::uint32_t kWrap = ~std::uint32_t{0};
+
+  void write_length(std::size_t offset, std::uint32_t length) noexcept {
+    std::memcpy(&m_bytes[offset], &length, sizeof(length));
+  }
+
+  alignas(64) std::atomic<std::uint64_t> m_head{0}; // consumer
+  std::atomic<std::uint64_t>             m_committed{0}; // consumer, up to `m_head`
+  alignas(64) std::atomic<std::uint64_t> m_tail{0}; // producer
+  std::size_t             m_mask;
+  std::unique_ptr<char[]> m_bytes;
+};
+
+// The rings of all the threads that have written binary records. A ring outlives its
+// thread until it has been drained.
+class RecordRings {
+public:
+  static RecordRings& instance() {
+    static RecordRings rings;
+    return rings;
+  }
+
+  std::shared_ptr<RecordRing> add() {
+    auto ring = std::make_shared<RecordRing>();
+    const std::lock_guard<std::mutex> lock(m_mutex);
+    m_rings.push_back(ring);
+    m_generation.fetch_add(1, std::memory_order_release);
+    return ring;
+  }
+
+  // Copies the current rings into `rings` if they changed since `generation`, dropping
+  // the drained rings of exited threads. There's a single consumer.
+  void update(std::vector<std::shared_ptr<RecordRing>>& rings, std::uint64_t& generation) {
+    if (m_generation.load(std::memory_order_acquire) == generation && !has_orphans(rings)) {
+      return;
+    }
+    const std::lock_guard<std::mutex> lock(m_mutex);
+    rings.clear();
+    std::erase_if(m_rings, [](const auto& ring) { return ring.use_count() == 1 && ring->empty(); });
+    rings = m_rings;
+    generation = m_generation.load(std::memory_order_relaxed);
+  }
+
+private:
+  static bool has_orphans(const std::vector<std::shared_ptr<RecordRing>>& rings) noexcept {
+    for (const auto& ring : rings) {
+      // Held by us, the registry, and its thread while it lives
+      if (ring.use_count() == 2 && ring->empty()) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  std::mutex                               m_mutex;
+  std::vector<std::shared_ptr<RecordRing>> m_rings;
+  std::atomic<std::uint64_t>               m_generation{0};
+};
+
+} // namespace detail
@@ -0,0 +1,188 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+namespace detail {
+
+// Recycles small heap blocks per thread, for objects such as queued work, which are
+// allocated on one thread and, typically, freed on another. Each thread allocates from
+// its own pool, with no synchronization, in a few size classes. A block freed by its
+// owner goes straight back to the owner's free list, while one freed by another thread
+// is pushed (one CAS) onto the owner's list of remote frees, which the owner takes over
+// whenever it runs out of blocks. When a thread exits, its pool lingers until all of its
+// blocks are freed.
+class BlockPool {
+public:
+  static constexpr std::size_t kAlignment = alignof(std::max_align_t);
+
+  [[nodiscard]] static void* allocate(std::size_t size) {
+    const std::uint32_t size_class = class_of(size);
+    if (size_class == kClassCount) {
+      return new_block(nullptr, size_class, size);
+    }
+    return local().take(size_class);
+  }
+
+  static void deallocate(void* payload) noexcept {
+    if (payload == nullptr) {
+      return;
+    }
+    Header* header = header_of(payload);
+    BlockPool* owner = header->owner;
+    if (owner == nullptr) {
+      ::operator delete(header);
+    } else if (owner == t_current) {
+      owner->give_back(payload, header->size_class);
+    } else {
+      owner->give_back_remote(payload);
+    }
+  }
+
+  BlockPool(const BlockPool&)            = delete;
+  BlockPool& operator=(const BlockPool&) = delete;
+
+private:
+  struct alignas(kAlignment) Header {
+    BlockPool*    owner;      // nullptr if the block is too big for the pool
+    std::uint32_t size_class;
+  };
+  // Lives in the payload of a free block
+  struct FreeBlock {
+    FreeBlock* next;
+  };
+
+  static constexpr std::uint32_t kClassCount   = 5;
+  static constexpr std::size_t   kSmallestSize = 64; // doubling with each class
+
+  static constexpr std::uint32_t class_of(std::size_t size) noexcept {
+    std::uint32_t size_class = 0;
+    while (size_class < kClassCount && size > (kSmallestSize << size_class)) {
+      ++size_class;
+    }
+    return size_class;
+  }
+
+  static Header* header_of(void* payload) noexcept { return static_cast<Header*>(payload) - 1; }
+
+  static void* new_block(BlockPool* owner, std::uint32_t size_class, std::size_t size) {
+    void* memory = ::operator new(sizeof(Header) + size);
+    return ::new (memory) Header{owner, size_class} + 1;
+  }
+
+  static void delete_block(void* payload) noexcept { ::operator delete(header_of(payload)); }
+
+  // Marks the list of remote frees of a pool whose thread has exited
+  static FreeBlock* orphaned() noexcept {
+    static FreeBlock sentinel{nullptr};
+    return &sentinel;
+  }
+
+  BlockPool() = default;
+  ~BlockPool() = default;
+
+  void* take(std::uint32_t size_class) {
+    FreeBlock*& free = m_free[size_class];
+    if (free == nullptr) {
+      take_remote_frees();
+    }
+    ++m_allocated;
+    if (free == nullptr) {
+      return new_block(this, size_class, kSmallestSize << size_class);
+    }
+    FreeBlock* block = free;
+    free = block->next;
+    return block;
+  }
+
+  void give_back(void* payload, std::uint32_t size_class) noexcept {
+    m_free[size_class] = ::new (payload) FreeBlock{m_free[size_class]};
+    --m_allocated;
+  }
+
+  void take_remote_frees() noexcept {
+    FreeBlock* block = m_remote.exchange(nullptr, std::memory_order_acquire);
+    while (block != nullptr) {
+      FreeBlock* next = block->next;
+      give_back(block, header_of(block)->size_class);
+      block = next;
+    }
+  }
+
+  void give_back_remote(void* payload) noexcept {
+    FreeBlock* block = ::new (payload) FreeBlock{nullptr};
+    FreeBlock* head = m_remote.load(std::memory_order_acquire);
+    do {
+      if (head == orphaned()) {
+        delete_block(block);
+        release_orphan(1);
+        return;
+      }
+      block->next = head;
+    } while (!m_remote.compare_exchange_weak(head, block, std::memory_order_release,
+                                             std::memory_order_acquire));
+  }
+
+  // Called when the owner thread exits: frees the blocks at hand, and leaves the others
+  // to free themselves as they come back.
+  void orphan() noexcept {
+    m_orphan_references.store(m_allocated + 1, std::memory_order_relaxed);
+    FreeBlock* remote = m_remote.exchange(orphaned(), std::memory_order_acq_rel);
+    std::size_t returned = 0;
+    for (; remote != nullptr; ++returned) {
+      FreeBlock* next = remote->next;
+      delete_block(remote);
+      remote = next;
+    }
+    for (FreeBlock* free : m_free) {
+      while (free != nullptr) {
+        FreeBlock* next = free->next;
+        delete_block(free);
+        free = next;
+      }
+    }
+    release_orphan(returned + 1);
+  }
+
+  void release_orphan(std::size_t count) noexcept {
+    if (m_orphan_references.fetch_sub(count, std::memory_order_acq_rel) == count) {
+      delete this;
+    }
+  }
+
+  static BlockPool& local() {
+    thread_local const Owner owner;
+    return *t_current;
+  }
+
+  // Creates the thread's pool, and orphans it when the thread exits.
+  struct Owner {
+    Owner() : pool(new BlockPool) { t_current = pool; }
+    ~Owner() {
+      t_current = nullptr;
+      pool->orphan();
+    }
+    BlockPool* pool;
+  };
+
+  static inline thread_local BlockPool* t_current = nullptr;
+
+  FreeBlock*               m_free[kClassCount] = {};
+  std::size_t              m_allocated         = 0; // blocks not on `m_free`, owner only
+  std::atomic<FreeBlock*>  m_remote{nullptr};
+  std::atomic<std::size_t> m_orphan_references{0};
+};
+
+// Makes `new` and `delete` of a class (and of the classes derived from it) use the
+// calling thread's `BlockPool`.
+struct PoolAllocated {
+  static void* operator new(std::size_t size) { return BlockPool::allocate(size); }
+  static void operator delete(void* object) noexcept { BlockPool::deallocate(object); }
+  // Over-aligned classes bypass the pool.
+  static void* operator new(std::size_t size, std::align_val_t alignment) { return ::operator new(size, alignment); }
+  static void operator delete(void* object, std::align_val_t alignment) noexcept { ::operator delete(object, alignment); }
+};
+
+} // namespace detail
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace Library {
+
+// Arguments of many `do_work()` calls stored column by column: all the first arguments
+// in one contiguous array, all the second ones in another, and so on. Pass it to
+// `Office::work_columns()`.
+template<typename... Ts>
+class Columns {
+  static_assert(sizeof...(Ts) > 0, "rows of no columns can't be counted");
+  using Indices = std::index_sequence_for<Ts...>;
+
+public:
+  [[nodiscard]] std::size_t size() const noexcept { return std::get<0>(m_columns).size(); }
+  [[nodiscard]] bool empty() const noexcept { return size() == 0; }
+
+  void reserve(std::size_t capacity) {
+    for_each_column([capacity](auto& column) { column.reserve(capacity); });
+  }
+  void clear() noexcept {
+    for_each_column([](auto& column) { column.clear(); });
+  }
+
+  // Appends one row, i.e. the arguments of one call.
+  template<typename... Us>
+  void push_back(Us&&... values) {
+    static_assert(sizeof...(Us) == sizeof...(Ts), "a row needs a value for every column");
+    push_back_impl(Indices(), std::forward<Us>(values)...);
+  }
+
+  template<std::size_t I>
+  [[nodiscard]] auto column() const noexcept {
+    return std::span<const std::tuple_element_t<I, std::tuple<Ts...>>>(std::get<I>(m_columns));
+  }
+
+private:
+  template<typename F>
+  void for_each_column(F&& f) {
+    std::apply([&f](auto&... columns) { (f(columns), ...); }, m_columns);
+  }
+
+  template<std::size_t... Is, typename... Us>
+  void push_back_impl(std::index_sequence<Is...>, Us&&... values) {
+    (std::get<Is>(m_columns).push_back(std::forward<Us>(values)), ...);
+  }
+
+  std::tuple<std::vector<Ts>...> m_columns;
+};
+
+} // namespace Library
@@ -0,0 +1,367 @@
+#pragma once
+
+#include "BlockPool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace detail {
+
+// Chase-Lev work-stealing deque of pointers, with the memory orderings of "Correct and
+// Efficient Work-Stealing for Weak Memory Models" (Lê et al., 2013). Its owner thread
+// pushes and pops at the bottom, like a stack, while any thread may steal from the top.
+// The ring grows as needed; the rings it outgrew are kept until the deque is destroyed,
+// since a thief may still be reading one.
+template<typename T>
+class WorkStealingDeque {
+  static_assert(std::is_pointer_v<T>, "the deque holds pointers");
+
+public:
+  explicit WorkStealingDeque(std::int64_t capacity = 256) {
+    assert(capacity > 0 && (capacity & (capacity - 1)) == 0);
+    m_rings.push_back(std::make_unique<Ring>(capacity));
+    m_ring.store(m_rings.back().get(), std::memory_order_relaxed);
+  }
+  WorkStealingDeque(const WorkStealingDeque&)            = delete;
+  WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+
+  // Owner only.
+  void push(T item) {
+    const std::int64_t bottom = m_bottom.load(std::memory_order_relaxed);
+    const std::int64_t top    = m_top.load(std::memory_order_acquire);
+    Ring* ring = m_ring.load(std::memory_order_relaxed);
+    if (bottom - top > ring->mask) {
+      ring = grow(ring, top, bottom);
+    }
+    ring->store(bottom, item);
+    std::atomic_thread_fence(std::memory_order_release);
+    m_bottom.store(bottom + 1, std::memory_order_relaxed);
+  }
+
+  // Owner only; returns nullptr if the deque is empty.
+  T pop() noexcept {
+    const std::int64_t bottom = m_bottom.load(std::memory_order_relaxed) - 1;
+    Ring* ring = m_ring.load(std::memory_order_relaxed);
+    m_bottom.store(bottom, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    std::int64_t top = m_top.load(std::memory_order_relaxed);
+    if (top > bottom) {
+      m_bottom.store(bottom + 1, std::memory_order_relaxed);
+      return nullptr;
+    }
+    T item = ring->load(bottom);
+    if (top == bottom) {
+      // The last item: race the thieves for it.
+      if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst,
+                                         std::memory_order_relaxed)) {
+        item = nullptr;
+      }
+      m_bottom.store(bottom + 1, std::memory_order_relaxed);
+    }
+    return item;
+  }
+
+  // Any thread; returns nullptr if the deque is empty or another thread won the race
+  // for the top item.
+  T steal() noexcept {
+    std::int64_t top = m_top.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    const std::int64_t bottom = m_bottom.load(std::memory_order_acquire);
+    if (top >= bottom) {
+      return nullptr;
+    }
+    T item = m_ring.load(std::memory_order_acquire)->load(top);
+    if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst,
+                                       std::memory_order_relaxed)) {
+      return nullptr;
+    }
+    return item;
+  }
+
+  // A snapshot, only exact when taken by the owner with no thief around.
+  [[nodiscard]] bool empty() const noexcept {
+    return m_bottom.load(std::memory_order_relaxed) <= m_top.load(std::memory_order_relaxed);
+  }
+
+private:
+  struct Ring {
+    explicit Ring(std::int64_t capacity)
+      : mask(capacity - 1), slots(std::make_unique<std::atomic<T>[]>(static_cast<std::size_t>(capacity))) {}
+
+    T load(std::int64_t index) const noexcept { return slots[static_cast<std::size_t>(index & mask)].load(std::memory_order_relaxed); }
+    void store(std::int64_t index, T item) noexcept { slots[static_cast<std::size_t>(index & mask)].store(item, std::memory_order_relaxed); }
+
+    std::int64_t                      mask;
+    std::unique_ptr<std::atomic<T>[]> slots;
+  };
+
+  Ring* grow(Ring* ring, std::int64_t top, std::int64_t bottom) {
+    auto bigger = std::make_unique<Ring>(2 * (ring->mask + 1));
+    for (std::int64_t i = top; i < bottom; ++i) {
+      bigger->store(i, ring->load(i));
+    }
+    ring = bigger.get();
+    m_rings.push_back(std::move(bigger));
+    m_ring.store(ring, std::memory_order_release);
+    return ring;
+  }
+
+  // The thieves hammer `m_top`, the owner `m_bottom`.
+  alignas(64) std::atomic<std::int64_t> m_top{0};
+  alignas(64) std::atomic<std::int64_t> m_bottom{0};
+  std::atomic<Ring*>                    m_ring{nullptr};
+  std::vector<std::unique_ptr<Ring>>    m_rings; // owner only
+};
+
+} // namespace detail
+
+namespace Library {
+
+// A thread pool running `Task`s, one work-stealing deque per thread. A task submitted
+// from one of the pool's threads goes to the bottom of that thread's deque, and is
+// likely run next by the same thread, with its data still in cache; other tasks go to
+// a shared queue, from which the threads take them in small batches. Idle threads steal
+// from the top of the others' deques, and sleep when there's nothing to steal.
+//
+// An exception escaping a task terminates the program, as it would escape a std::thread.
+class Executor {
+public:
+  // A unit of work. Tasks are intrusive, so that submitting one doesn't allocate: whoever
+  // submits a task keeps it alive until it has run, which is why a task may delete itself.
+  class Task {
+  public:
+    explicit Task(void (*run_function)(Task&)) noexcept : m_run(run_function) {}
+    Task(const Task&)            = delete;
+    Task& operator=(const Task&) = delete;
+
+    void run() { m_run(*this); }
+
+  protected:
+    ~Task() = default;
+
+  private:
+    void (*m_run)(Task&);
+  };
+
+  explicit Executor(unsigned thread_count = default_thread_count()) {
+    thread_count = std::max(thread_count, 1u);
+    m_workers.reserve(thread_count);
+    for (unsigned i = 0; i < thread_count; ++i) {
+      m_workers.push_back(std::make_unique<Worker>(i));
+    }
+    for (const auto& worker : m_workers) {
+      worker->thread = std::thread([this, &worker = *worker] { run_worker(worker); });
+    }
+  }
+
+  // Runs the tasks still queued, then joins the threads.
+  ~Executor() {
+    wait_idle();
+    {
+      const std::lock_guard<std::mutex> lock(m_sleep_mutex);
+      m_stopping = true;
+    }
+    m_wake.notify_all();
+    for (const auto& worker : m_workers) {
+      worker->thread.join();
+    }
+  }
+
+  Executor(const Executor&)            = delete;
+  Executor& operator=(const Executor&) = delete;
+
+  [[nodiscard]] static unsigned default_thread_count() noexcept {
+    return std::max(std::thread::hardware_concurrency(), 1u);
+  }
+  [[nodiscard]] unsigned thread_count() const noexcept { return static_cast<unsigned>(m_workers.size()); }
+
+  // Queues `task`, which must stay alive until it has run.
+  void submit(Task& task) {
+    m_pending.fetch_add(1, std::memory_order_relaxed);
+    if (Worker* worker = t_worker; worker != nullptr && worker->executor == this) {
+      worker->deque.push(&task);
+    } else {
+      const std::lock_guard<std::mutex> lock(m_injected_mutex);
+      m_injected.push_back(&task);
+      m_injected_count.store(m_injected.size(), std::memory_order_relaxed);
+    }
+    wake_one();
+  }
+
+  // Queues a call to `function()`; unlike `submit(Task&)`, this allocates the task,
+  // from the calling thread's `detail::BlockPool`.
+  template<typename F,
+           typename = std::enable_if_t<!std::is_base_of_v<Task, std::decay_t<F>>>>
+  void submit(F&& function) {
+    submit(*new FunctionTask<std::decay_t<F>>(std::forward<F>(function)));
+  }
+
+  // Blocks until every submitted task, including those submitted by tasks, has run.
+  // Mustn't be called from a task.
+  void wait_idle() {
+    assert(t_worker == nullptr || t_worker->executor != this);
+    std::unique_lock<std::mutex> lock(m_idle_mutex);
+    m_idle.wait(lock, [this] { return m_pending.load(std::memory_order_acquire) == 0; });
+  }
+
+private:
+  template<typename F>
+  struct FunctionTask final : public Task, public detail::PoolAllocated {
+    template<typename G>
+    explicit FunctionTask(G&& function) : Task(&FunctionTask::run_and_delete), m_function(std::forward<G>(function)) {}
+
+    static void run_and_delete(Task& task) {
+      const std::unique_ptr<FunctionTask> self(static_cast<FunctionTask*>(&task));
+      self->m_function();
+    }
+
+    F m_function;
+  };
+
+  struct alignas(64) Worker {
+    explicit Worker(unsigned i) : index(i) {}
+
+    detail::WorkStealingDeque<Task*> deque;
+    unsigned                           index;
+    const Executor*                    executor = nullptr;
+    std::thread                        thread;
+  };
+
+  // Most tasks a thread moves at once from the shared queue to its deque
+  static constexpr std::size_t kInjectedBatch = 32;
+  // Times an idle thread looks for work again before going to sleep
+  static constexpr int kSpinsBeforeSleep = 64;
+
+  void run_worker(Worker& self) {
+    self.executor = this;
+    t_worker = &self;
+    for (;;) {
+      Task* task = nullptr;
+      for (int spin = 0; task == nullptr && spin < kSpinsBeforeSleep; ++spin) {
+        if ((task = find_task(self)) == nullptr) {
+          std::this_thread::yield();
+        }
+      }
+      if (task != nullptr) {
+        task->run();
+        if (m_pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+          { const std::lock_guard<std::mutex> lock(m_idle_mutex); }
+          m_idle.notify_all();
+        }
+      } else if (!wait_for_work()) {
+        break;
+      }
+    }
+    t_worker = nullptr;
+  }
+
+  Task* find_task(Worker& self) {
+    if (Task* task = self.deque.pop()) {
+      return task;
+    }
+    if (Task* task = take_injected(self)) {
+      return task;
+    }
+    const std::size_t count = m_workers.size();
+    for (std::size_t i = 1; i < count; ++i) {
+      if (Task* task = m_workers[(self.index + i) % count]->deque.steal()) {
+        return task;
+      }
+    }
+    return nullptr;
+  }
+
+  // Takes a task from the shared queue to run, and moves a few more to `self`'s deque
+  // where the other threads can steal them.
+  Task* take_injected(Worker& self) {
+    if (m_injected_count.load(std::memory_order_relaxed) == 0) {
+      return nullptr;
+    }
+    const std::lock_guard<std::mutex> lock(m_injected_mutex);
+    if (m_injected.empty()) {
+      return nullptr;
+    }
+    Task* task = m_injected.front();
+    m_injected.pop_front();
+    const std::size_t share = std::min(m_injected.size() / m_workers.size(), kInjectedBatch);
+    for (std::size_t i = 0; i < share; ++i) {
+      self.deque.push(m_injected.front());
+      m_injected.pop_front();
+    }
+    m_injected_count.store(m_injected.size(), std::memory_order_relaxed);
+    return task;
+  }
+
+  [[nodiscard]] bool has_work() const noexcept {
+    if (m_injected_count.load(std::memory_order_relaxed) != 0) {
+      return true;
+    }
+    return std::any_of(m_workers.begin(), m_workers.end(),
+                       [](const auto& worker) { return !worker->deque.empty(); });
+  }
+
+  // Either the sleeping thread sees the task that was just submitted, or the submitter
+  // sees the sleeper: both sides issue a full fence between publishing their own state
+  // and reading the other's.
+  void wake_one() {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (m_sleepers.load(std::memory_order_relaxed) > 0) {
+      {
+        const std::lock_guard<std::mutex> lock(m_sleep_mutex);
+        ++m_wake_signal;
+      }
+      m_wake.notify_one();
+    }
+  }
+
+  // Returns false when the executor is being destroyed.
+  bool wait_for_work() {
+    std::unique_lock<std::mutex> lock(m_sleep_mutex);
+    m_sleepers.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (!has_work() && !m_stopping) {
+      const std::uint64_t signal = m_wake_signal;
+      m_wake.wait(lock, [&] { return m_wake_signal != signal || m_stopping; });
+    }
+    m_sleepers.fetch_sub(1, std::memory_order_relaxed);
+    return !m_stopping;
+  }
+
+  static inline thread_local Worker* t_worker = nullptr;
+
+  std::vector<std::unique_ptr<Worker>> m_workers;
+
+  std::mutex               m_injected_mutex;
+  std::deque<Task*>        m_injected;
+  std::atomic<std::size_t> m_injected_count{0};
+
+  std::atomic<std::size_t> m_pending{0}; // submitted but not yet run
+  std::mutex               m_idle_mutex;
+  std::condition_variable  m_idle;
+
+  std::atomic<unsigned>    m_sleepers{0};
+  std::mutex               m_sleep_mutex;
+  std::condition_variable  m_wake;
+  std::uint64_t            m_wake_signal = 0;
+  bool                     m_stopping    = false;
+};
+
+// The executor of `Office::work_async()` calls that don't name one, with a thread per
+// hardware thread, started on first use.
+inline Executor& default_executor() {
+  static Executor executor;
+  return executor;
+}
+
+} // namespace Library
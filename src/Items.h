@@ -0,0 +1,139 @@
+#pragma once
+
+// Items passed to `Library::Office::work()` by the example in main.cpp.
+
+#include "Names.h"
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <vector>
+
+struct Monitor  { [[nodiscard]] static constexpr std::string_view name() noexcept { return "monitor";  } };
+struct Keyboard { [[nodiscard]] static constexpr std::string_view name() noexcept { return "keyboard"; } };
+struct Cup      { [[nodiscard]] static constexpr std::string_view name() noexcept { return "coffee";   } };
+
+// Recipes and ingredients reuse a small vocabulary of names, so they are handles to
+// names interned in a catalog of their own, with dense ids: 4 bytes each, which are
+// looked up without locking once the names are known.
+class Recipe {
+public:
+  Recipe() noexcept : m_name(unnamed()) {}
+  explicit Recipe(std::string_view name) : m_name(name) {}
+  [[nodiscard]] std::string_view name() const noexcept { return m_name.view(); }
+  [[nodiscard]] std::uint32_t id() const noexcept { return m_name.id(); }
+  friend bool operator==(Recipe a, Recipe b) noexcept { return a.m_name == b.m_name; }
+private:
+  static Library::InternedName<Recipe> unnamed() noexcept {
+    static const Library::InternedName<Recipe> name("recipe");
+    return name;
+  }
+  Library::InternedName<Recipe> m_name;
+};
+
+class Ingredient {
+public:
+  Ingredient() noexcept : m_name(unnamed()) {}
+  Ingredient(std::string_view name) : m_name(name) {}
+  [[nodiscard]] std::string_view name() const noexcept { return m_name.view(); }
+  [[nodiscard]] std::uint32_t id() const noexcept { return m_name.id(); }
+  friend bool operator==(Ingredient a, Ingredient b) noexcept { return a.m_name == b.m_name; }
+private:
+  static Library::InternedName<Ingredient> unnamed() noexcept {
+    static const Library::InternedName<Ingredient> name("stuff");
+    return name;
+  }
+  Library::InternedName<Ingredient> m_name;
+};
+
+// The ingredients of a recipe, by name: all the names are stored one after the other in
+// a single buffer, along with the offset where each one ends, so that a list of any size
+// takes two allocations, moves in constant time, and iterates over contiguous memory.
+class IngredientList {
+public:
+  class const_iterator {
+  public:
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type        = std::string_view;
+    using difference_type   = std::ptrdiff_t;
+    using pointer           = void;
+    using reference         = std::string_view;
+
+    const_iterator() noexcept = default;
+    std::string_view operator*() const noexcept { return (*m_list)[m_index]; }
+    std::string_view operator[](difference_type n) const noexcept { return *(*this + n); }
+    const_iterator& operator++() noexcept { ++m_index; return *this; }
+    const_iterator operator++(int) noexcept { const_iterator old = *this; ++m_index; return old; }
+    const_iterator& operator--() noexcept { --m_index; return *this; }
+    const_iterator operator--(int) noexcept { const_iterator old = *this; --m_index; return old; }
+    const_iterator& operator+=(difference_type n) noexcept { m_index = advanced(n); return *this; }
+    const_iterator& operator-=(difference_type n) noexcept { m_index = advanced(-n); return *this; }
+    friend const_iterator operator+(const_iterator i, difference_type n) noexcept { return i += n; }
+    friend const_iterator operator+(difference_type n, const_iterator i) noexcept { return i += n; }
+    friend const_iterator operator-(const_iterator i, difference_type n) noexcept { return i -= n; }
+    friend difference_type operator-(const const_iterator& a, const const_iterator& b) noexcept {
+      return static_cast<difference_type>(a.m_index) - static_cast<difference_type>(b.m_index);
+    }
+    friend bool operator==(const const_iterator& a, const const_iterator& b) noexcept { return a.m_index == b.m_index; }
+    friend auto operator<=>(const const_iterator& a, const const_iterator& b) noexcept { return a.m_index <=> b.m_index; }
+
+  private:
+    friend class IngredientList;
+    const_iterator(const IngredientList& list, std::size_t index) noexcept : m_list(&list), m_index(index) {}
+    std::size_t advanced(difference_type n) const noexcept {
+      return static_cast<std::size_t>(static_cast<difference_type>(m_index) + n);
+    }
+
+    const IngredientList* m_list  = nullptr;
+    std::size_t           m_index = 0;
+  };
+
+  IngredientList() = default;
+  IngredientList(std::initializer_list<std::string_view> names) {
+    std::size_t chars = 0;
+    for (const std::string_view name : names) {
+      chars += name.size();
+    }
+    reserve(names.size(), chars);
+    for (const std::string_view name : names) {
+      push_back(name);
+    }
+  }
+
+  // Makes room for `count` more names of `chars` characters in all.
+  void reserve(std::size_t count, std::size_t chars) {
+    m_ends.reserve(m_ends.size() + count);
+    m_chars.reserve(m_chars.size() + chars);
+  }
+
+  void push_back(std::string_view name) {
+    m_chars.append(name);
+    assert(m_chars.size() <= UINT32_MAX);
+    m_ends.push_back(static_cast<std::uint32_t>(m_chars.size()));
+  }
+  void push_back(Ingredient ingredient) { push_back(ingredient.name()); }
+
+  void clear() noexcept {
+    m_chars.clear();
+    m_ends.clear();
+  }
+
+  [[nodiscard]] std::size_t size() const noexcept { return m_ends.size(); }
+  [[nodiscard]] bool empty() const noexcept { return m_ends.empty(); }
+
+  [[nodiscard]] std::string_view operator[](std::size_t index) const noexcept {
+    const std::uint32_t begin = index == 0 ? 0 : m_ends[index - 1];
+    return std::string_view(m_chars).substr(begin, m_ends[index] - begin);
+  }
+
+  [[nodiscard]] const_iterator begin() const noexcept { return {*this, 0}; }
+  [[nodiscard]] const_iterator end() const noexcept { return {*this, size()}; }
+
+private:
+  std::string                m_chars; // all the names, back to back
+  std::vector<std::uint32_t> m_ends;  // where each name ends in `m_chars`
+};
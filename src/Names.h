@@ -0,0 +1,222 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+namespace detail {
+
+struct NameEntry {
+  std::uint32_t id;
+  std::uint32_t size;
+  const char*   chars;
+};
+
+// Append-only table of names, each stored once, with dense ids from 0 (the empty name).
+// The characters live in blocks that never move, and the entries in segments of
+// doubling size that never move either, so that an entry, once added, can be used, and
+// found by id, without locking. Names are found by text in an open-addressing index
+// that is read without locking too: adding a name takes a mutex, and so does growing
+// the index, which replaces it with a bigger copy but keeps the old one for readers
+// that still use it. Once the names in use have been added, nothing takes the mutex.
+class NameTable {
+public:
+  NameTable() { intern({}); }
+  ~NameTable() {
+    for (auto& segment : m_segments) {
+      delete[] segment.load(std::memory_order_relaxed);
+    }
+  }
+  NameTable(const NameTable&)            = delete;
+  NameTable& operator=(const NameTable&) = delete;
+
+  // Returns the entry of `text`, which is added if it's new.
+  const NameEntry& intern(std::string_view text) {
+    const std::size_t hash = std::hash<std::string_view>{}(text);
+    if (const NameEntry* entry = find(text, hash)) {
+      return *entry;
+    }
+    const std::lock_guard<std::mutex> lock(m_mutex);
+    if (const NameEntry* entry = find(text, hash)) {
+      return *entry; // added in the meantime
+    }
+    const auto id = m_count.load(std::memory_order_relaxed);
+    const auto [segment, offset] = locate(id);
+    if (offset == 0) {
+      m_segments[segment].store(new NameEntry[kFirstSegmentSize << segment], std::memory_order_relaxed);
+    }
+    NameEntry& entry = m_segments[segment].load(std::memory_order_relaxed)[offset];
+    entry = {id, static_cast<std::uint32_t>(text.size()), store(text)};
+    m_count.store(id + 1, std::memory_order_release);
+    add_to_index(id, hash);
+    return entry;
+  }
+
+  // The entry of `text`, or nullptr if it hasn't been added.
+  [[nodiscard]] const NameEntry* find(std::string_view text) const noexcept {
+    return find(text, std::hash<std::string_view>{}(text));
+  }
+
+  // `id` must come from an entry, possibly added by another thread.
+  const NameEntry& operator[](std::uint32_t id) const noexcept {
+    assert(id < m_count.load(std::memory_order_acquire));
+    const auto [segment, offset] = locate(id);
+    return m_segments[segment].load(std::memory_order_acquire)[offset];
+  }
+
+  [[nodiscard]] std::size_t size() const noexcept { return m_count.load(std::memory_order_acquire); }
+
+private:
+  static constexpr std::size_t kFirstSegmentSize = 64;
+  static constexpr std::size_t kSegmentCount     = 26; // enough for any 32-bit id
+  static constexpr std::size_t kBlockSize        = 64 * 1024;
+  static constexpr std::size_t kFirstIndexSize   = 256;
+
+  struct Location {
+    std::size_t segment;
+    std::size_t offset;
+  };
+  static Location locate(std::uint32_t id) noexcept {
+    const std::size_t segment = std::bit_width(id / kFirstSegmentSize + 1) - 1;
+    return {segment, id - kFirstSegmentSize * ((std::size_t{1} << segment) - 1)};
+  }
+
+  // Each slot is 0 if empty, or the upper half of the hash of a name and its id + 1.
+  struct Index {
+    explicit Index(std::size_t size) : mask(size - 1), slots(std::make_unique<std::atomic<std::uint64_t>[]>(size)) {}
+    std::size_t                                  mask;
+    std::unique_ptr<std::atomic<std::uint64_t>[]> slots;
+  };
+
+  static std::uint64_t slot_of(std::uint32_t id, std::size_t hash) noexcept {
+    return std::uint64_t{static_cast<std::uint32_t>(std::uint64_t{hash} >> 32)} << 32 | (std::uint64_t{id} + 1);
+  }
+
+  const NameEntry* find(std::string_view text, std::size_t hash) const noexcept {
+    const Index* index = m_index.load(std::memory_order_acquire);
+    if (index == nullptr) {
+      return nullptr;
+    }
+    const std::uint64_t high = slot_of(0, hash) & ~std::uint64_t{UINT32_MAX};
+    for (std::size_t i = hash & index->mask;; i = (i + 1) & index->mask) {
+      const std::uint64_t slot = index->slots[i].load(std::memory_order_acquire);
+      if (slot == 0) {
+        return nullptr;
+      }
+      if ((slot & ~std::uint64_t{UINT32_MAX}) == high) {
+        const NameEntry& entry = (*this)[static_cast<std::uint32_t>(slot) - 1];
+        if (std::string_view(entry.chars, entry.size) == text) {
+          return &entry;
+        }
+      }
+    }
+  }
+
+  // Under the mutex; keeps the index at most half full.
+  void add_to_index(std::uint32_t id, std::size_t hash) {
+    Index* index = m_index.load(std::memory_order_relaxed);
+    if (index == nullptr || 2 * (std::size_t{id} + 1) > index->mask + 1) {
+      auto bigger = std::make_unique<Index>(index == nullptr ? kFirstIndexSize : 2 * (index->mask + 1));
+      for (std::uint32_t other = 0; other < id; ++other) {
+        const NameEntry& entry = (*this)[other];
+        insert(*bigger, other, std::hash<std::string_view>{}(std::string_view(entry.chars, entry.size)));
+      }
+      index = bigger.get();
+      m_indexes.push_back(std::move(bigger));
+    }
+    insert(*index, id, hash);
+    m_index.store(index, std::memory_order_release);
+  }
+
+  static void insert(Index& index, std::uint32_t id, std::size_t hash) noexcept {
+    std::size_t i = hash & index.mask;
+    while (index.slots[i].load(std::memory_order_relaxed) != 0) {
+      i = (i + 1) & index.mask;
+    }
+    index.slots[i].store(slot_of(id, hash), std::memory_order_release);
+  }
+
+  // Copies `text` to the current block, or to a block of its own if it's big.
+  const char* store(std::string_view text) {
+    if (text.size() > m_left) {
+      const std::size_t size = std::max(kBlockSize, text.size());
+      m_blocks.push_back(std::make_unique<char[]>(size));
+      m_next = m_blocks.back().get();
+      m_left = size;
+    }
+    char* chars = m_next;
+    if (!text.empty()) {
+      std::memcpy(chars, text.data(), text.size());
+    }
+    m_next += text.size();
+    m_left -= text.size();
+    return chars;
+  }
+
+  std::mutex                           m_mutex;
+  std::vector<std::unique_ptr<char[]>> m_blocks;
+  char*                                m_next = nullptr;
+  std::size_t                          m_left = 0;
+  std::atomic<NameEntry*>              m_segments[kSegmentCount] = {};
+  std::atomic<std::uint32_t>           m_count{0};
+  std::atomic<Index*>                  m_index{nullptr};
+  std::vector<std::unique_ptr<Index>>  m_indexes; // the current one last
+};
+
+} // namespace detail
+
+namespace Library {
+
+// Handle to a name interned in the `detail::NameTable` of names of kind `Kind`, which
+// gives the names of each kind dense ids of their own. A handle is just the 4-byte id:
+// copying it never copies the characters, and two handles are equal if their ids are.
+template<typename Kind>
+class InternedName {
+public:
+  // The empty name, with id 0
+  InternedName() noexcept = default;
+  explicit InternedName(std::string_view text) : m_id(table().intern(text).id) {}
+
+  // The name with an id that `id()` returned, on any thread
+  [[nodiscard]] static InternedName from_id(std::uint32_t id) noexcept { return InternedName(id); }
+  // The name `text`, if it has been interned; never blocks.
+  [[nodiscard]] static std::optional<InternedName> find(std::string_view text) noexcept {
+    if (const detail::NameEntry* entry = table().find(text)) {
+      return InternedName(entry->id);
+    }
+    return std::nullopt;
+  }
+
+  [[nodiscard]] std::uint32_t id() const noexcept { return m_id; }
+  [[nodiscard]] std::string_view view() const noexcept {
+    const detail::NameEntry& entry = table()[m_id];
+    return {entry.chars, entry.size};
+  }
+
+  friend bool operator==(InternedName a, InternedName b) noexcept { return a.m_id == b.m_id; }
+
+  static detail::NameTable& table() {
+    static detail::NameTable names;
+    return names;
+  }
+
+private:
+  explicit InternedName(std::uint32_t id) noexcept : m_id(id) {}
+
+  std::uint32_t m_id = 0;
+};
+
+// The name of a `Library::Person`
+using Name = InternedName<class Person>;
+
+} // namespace Library
@@ -0,0 +1,213 @@
+#pragma once
+
+#include "AnyPerson.h"
+#include "Executor.h"
+#include "Names.h"
+#include "Output.h"
+#include "WorkFuture.h"
+
+#include <memory>
+#include <span>
+#include <string>
+#include <tuple>
+#include <type_traits>
+
+namespace Library {
+class Person {
+public:
+  explicit Person(std::string_view name) : m_name(name) {}
+  virtual ~Person() = default;
+  Person(const Person&)                = default;
+  Person(Person&&) noexcept            = default;
+  Person& operator=(const Person&)     = default;
+  Person& operator=(Person&&) noexcept = default;
+  [[nodiscard]] Name name() const noexcept { return m_name; }
+  // no virtual do_work() method!
+private:
+  Name m_name; // interned, so that copying a person doesn't copy its name
+};
+
+class Office {
+public:
+  explicit Office(AnyPerson person) : m_person(std::move(person)) {}
+
+  // If the person's `do_work()` is a coroutine, returns the work in progress, which the
+  // caller may `co_await`; otherwise the work is done by the time `work()` returns. The
+  // coroutine keeps the person alive, so this `Office` may be moved or destroyed in the
+  // meantime (see `WorkTask`).
+  template<typename... Args>
+  WorkTask work(Args&&... args) {
+#if LIBRARY_HAS_USDT
+    if (LIBRARY_PROBE_ENABLED(office_work_entry)) {
+      LIBRARY_PROBE3(office_work_entry, m_person.name().id(),
+                     detail::signature_of<std::decay_t<Args>...>.fingerprint, detail::probe_now());
+    }
+#endif
+    const OutputRecord record;
+    out() << m_person.name() << static_text<" is ">;
+    return m_person.work(std::forward<Args>(args)...);
+  }
+
+  // Like `work()`, but returns mismatched arguments as an error (printing nothing)
+  // rather than throwing.
+  template<typename... Args>
+  [[nodiscard]] WorkResult try_work(Args&&... args) {
+    OutputRecord record;
+    out() << m_person.name() << static_text<" is ">;
+    const WorkResult result = m_person.try_work(std::forward<Args>(args)...);
+    if (!result) {
+      record.drop();
+    }
+    return result;
+  }
+
+  // Calls `do_work()` with each of `items`, paying for the type erasure and the
+  // signature check once per batch rather than once per item.
+  template<typename... Args>
+  void work_batch(std::span<const std::tuple<Args...>> items) {
+    const OutputRecord record;
+    out() << m_person.name() << static_text<" is ">;
+    m_person.work_batch(items);
+  }
+  template<typename... Args>
+  void work_batch(std::span<std::tuple<Args...>> items) { work_batch(std::span<const std::tuple<Args...>>(items)); }
+
+  template<typename... Args>
+  [[nodiscard]] WorkResult try_work_batch(std::span<const std::tuple<Args...>> items) {
+    if (const WorkResult result = m_person.check_work<Args...>(); !result) {
+      return result;
+    }
+    OutputRecord record;
+    out() << m_person.name() << static_text<" is ">;
+    const WorkResult result = m_person.try_work_batch(items);
+    if (!result) {
+      record.drop();
+    }
+    return result;
+  }
+  template<typename... Args>
+  [[nodiscard]] WorkResult try_work_batch(std::span<std::tuple<Args...>> items) {
+    return try_work_batch(std::span<const std::tuple<Args...>>(items));
+  }
+
+  // Calls the person's `do_work_bulk()` with whole columns, or `do_work()` with each row
+  // if it has none; see `Library::Columns`.
+  template<typename... Args>
+  void work_columns(const Columns<Args...>& columns) {
+    const OutputRecord record;
+    out() << m_person.name() << static_text<" is ">;
+    m_person.work_columns(columns);
+  }
+
+  template<typename... Args>
+  [[nodiscard]] WorkResult try_work_columns(const Columns<Args...>& columns) {
+    if (const WorkResult result = m_person.check_work<Args...>(); !result) {
+      return result;
+    }
+    OutputRecord record;
+    out() << m_person.name() << static_text<" is ">;
+    const WorkResult result = m_person.try_work_columns(columns);
+    if (!result) {
+      record.drop();
+    }
+    return result;
+  }
+
+  // Queues `work(args...)` on `executor`, to be run by one of its threads. The arguments
+  // are copied (or moved, so move-only ones must be rvalues) into the queued work item,
+  // which moves them into `do_work()`'s value parameters. They're checked right away, so that
+  // mismatched ones throw here rather than on the executor's thread. The office must
+  // outlive the work, and its person's `do_work()` be safe to call concurrently. If
+  // `do_work()` is a coroutine, the queued work only starts it.
+  template<typename... Args>
+  void submit_work(Executor& executor, Args&&... args) {
+    static_assert(kCanQueue<Args...>, "queued work owns its arguments: pass move-only ones as rvalues");
+    if (const WorkResult result = m_person.check_work<Args...>(); !result) {
+      detail::raise_work_error(result);
+    }
+    executor.submit(*new QueuedWork<std::decay_t<Args>...>(*this, std::forward<Args>(args)...));
+  }
+
+  // Like `submit_work()`, but returns a handle to wait for the work with. Both the queued
+  // work and the handle's shared state live in a single block from the calling thread's
+  // `detail::BlockPool`, which, once warmed up, doesn't allocate.
+  template<typename... Args>
+  [[nodiscard]] WorkFuture work_async(Executor& executor, Args&&... args) {
+    static_assert(kCanQueue<Args...>, "queued work owns its arguments: pass move-only ones as rvalues");
+    if (const WorkResult result = m_person.check_work<Args...>(); !result) {
+      detail::raise_work_error(result);
+    }
+    auto* work = new AsyncWork<std::decay_t<Args>...>(*this, std::forward<Args>(args)...);
+    WorkFuture future(*work);
+    executor.submit(*work);
+    return future;
+  }
+
+  // `work_async()` on `default_executor()`
+  template<typename... Args>
+  [[nodiscard]] WorkFuture work_async(Args&&... args) {
+    return work_async(default_executor(), std::forward<Args>(args)...);
+  }
+
+private:
+  template<typename... Args>
+  static constexpr bool kCanQueue = (std::is_constructible_v<std::decay_t<Args>, Args&&> && ...);
+
+  // A `work()` call waiting in an `Executor`: the office, which holds the erased person,
+  // and a frame owning the arguments.
+  template<typename... Args>
+  class QueuedWork : public Executor::Task, public detail::PoolAllocated {
+  public:
+    template<typename... T>
+    explicit QueuedWork(Office& office, T&&... arguments)
+      : QueuedWork(&QueuedWork::run_and_delete, office, std::forward<T>(arguments)...) {}
+
+  protected:
+    template<typename... T>
+    QueuedWork(void (*run_function)(Executor::Task&), Office& office, T&&... arguments)
+      : Task(run_function), m_office(office), m_frame(std::forward<T>(arguments)...) {}
+
+    void run_work() {
+      const OutputRecord record;
+      out() << m_office.m_person.name() << static_text<" is ">;
+      // The arguments were checked when the work was queued.
+      static_cast<void>(m_office.m_person.try_work_frame(m_frame.ref()));
+    }
+
+  private:
+    static void run_and_delete(Executor::Task& task) {
+      const std::unique_ptr<QueuedWork> self(static_cast<QueuedWork*>(&task));
+      self->run_work();
+    }
+
+    Office&                     m_office;
+    detail::ArgFrame<Args...> m_frame;
+  };
+
+  // Queued work that completes a `WorkFuture`, which may outlive it or not.
+  template<typename... Args>
+  class AsyncWork final : public QueuedWork<Args...>, public detail::AsyncState {
+  public:
+    template<typename... T>
+    explicit AsyncWork(Office& office, T&&... arguments)
+      : QueuedWork<Args...>(&AsyncWork::run_and_complete, office, std::forward<T>(arguments)...) {}
+
+  private:
+    static void run_and_complete(Executor::Task& task) {
+      auto& self = static_cast<AsyncWork&>(task);
+#if LIBRARY_HAS_EXCEPTIONS
+      try {
+        self.run_work();
+      } catch (...) {
+        self.fail(std::current_exception());
+      }
+#else
+      self.run_work();
+#endif
+      self.complete();
+    }
+  };
+
+  AnyPerson m_person;
+};
+} // namespace Library
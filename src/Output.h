@@ -0,0 +1,468 @@
+#pragma once
+
+// The lines that `Office` and the persons print, e.g. "Alice is working on recipe ...",
+// are composed piece by piece in a per-thread buffer, through `Library::out()`, and
+// committed as whole records when the outermost `OutputRecord` ends. Text written
+// outside of any record, such as by a coroutine `do_work()` once it resumed, is committed
+// as a record of its own when the thread's next record begins or it flushes. The thread
+// hands its committed records to the `OutputSink` in batches, as its `FlushPolicy` says,
+// so that records of concurrent calls never interleave, and a call costs no system call
+// of its own (unless the policy is `per_record()`). While a `Library::BinaryLog` is
+// active, records are binary instead, and formatted by the log's own thread.
+
+#include "BinaryRecords.h"
+#include "Names.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <exception>
+#include <iostream>
+#include <mutex>
+#include <streambuf>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+
+namespace Library {
+
+// Where the records go. `write()` is given whole records, each ending with '\n', and
+// is only called by one thread at a time.
+class OutputSink {
+public:
+  OutputSink() = default;
+  OutputSink(const OutputSink&)            = delete;
+  OutputSink& operator=(const OutputSink&) = delete;
+  // A sink that is still in use is replaced by the default one, which then gets the
+  // records still pending: call `flush_output()` before.
+  virtual ~OutputSink();
+
+  void commit(std::string_view records) {
+    const std::lock_guard<std::mutex> lock(m_mutex);
+    write(records);
+  }
+
+protected:
+  virtual void write(std::string_view records) = 0;
+
+private:
+  std::mutex m_mutex;
+};
+
+// Writes the records to a `std::ostream`, `std::cout` by default, and flushes it.
+class StreamSink final : public OutputSink {
+public:
+  explicit StreamSink(std::ostream& stream = std::cout) : m_stream(stream) {}
+  ~StreamSink() override = default;
+
+protected:
+  void write(std::string_view records) override {
+    m_stream.write(records.data(), static_cast<std::streamsize>(records.size()));
+    m_stream.flush();
+  }
+
+private:
+  std::ostream& m_stream;
+};
+
+// Writes the records to a C file, unbuffered: a batch of records is one system call.
+class FileSink final : public OutputSink {
+public:
+  explicit FileSink(std::FILE* file) : m_file(file) { std::setvbuf(m_file, nullptr, _IONBF, 0); }
+  ~FileSink() override = default;
+
+protected:
+  void write(std::string_view records) override { std::fwrite(records.data(), 1, records.size(), m_file); }
+
+private:
+  std::FILE* m_file;
+};
+
+// When a thread hands its committed records to the sink
+struct FlushPolicy {
+  enum class Mode : std::uint8_t {
+    PerRecord, // each record right away, as `std::endl` would
+    Size,      // once they take `bytes`
+    Interval,  // once `interval` has passed since the last time, or they take `bytes`
+  };
+
+  static constexpr FlushPolicy per_record() noexcept { return {Mode::PerRecord}; }
+  static constexpr FlushPolicy size(std::size_t bytes) noexcept { return {Mode::Size, bytes}; }
+  // The interval is checked as each record is committed, not by a timer: the records of
+  // a thread that stopped printing wait for its exit or its call to `flush_output()`.
+  static constexpr FlushPolicy every(std::chrono::nanoseconds interval, std::size_t bytes = std::size_t{1} << 20) noexcept {
+    return {Mode::Interval, bytes, interval};
+  }
+
+  Mode                     mode     = Mode::PerRecord;
+  std::size_t              bytes    = 64 * 1024;
+  std::chrono::nanoseconds interval = std::chrono::milliseconds(100);
+};
+
+// Sends the records of all the threads to `sink`, which must outlive its use, flushing
+// them as `policy` says. Threads flush their pending records at exit, with
+// `flush_output()`, or along with their next record: set the output up before other
+// threads start printing.
+void set_output(OutputSink& sink, FlushPolicy policy = FlushPolicy::per_record());
+// The default output: `std::cout`, flushed after each record
+void reset_output();
+// Hands the calling thread's committed records to the sink.
+void flush_output();
+
+class OutputStream;
+
+// The calling thread's record in progress
+OutputStream& out();
+
+// Delimits a record: the text written to `out()` while the outermost `OutputRecord` is
+// alive is committed as one record, ending with '\n', when it's destroyed (or dropped,
+// if an exception is unwinding it).
+class OutputRecord {
+public:
+  OutputRecord();
+  ~OutputRecord();
+  OutputRecord(const OutputRecord&)            = delete;
+  OutputRecord& operator=(const OutputRecord&) = delete;
+
+  // Drops the record rather than committing it, if this is the outermost one.
+  void drop() noexcept { m_dropped = true; }
+
+private:
+  int  m_uncaught_exceptions;
+  bool m_dropped = false;
+};
+
+} // namespace Library
+
+namespace detail {
+
+class ThreadOutput;
+
+// A string literal, as a template argument
+template<std::size_t N>
+struct FixedText {
+  char chars[N] = {};
+  constexpr FixedText(const char (&text)[N]) noexcept { std::copy_n(text, N, chars); }
+  [[nodiscard]] constexpr std::string_view view() const noexcept { return {chars, N - 1}; }
+};
+
+template<FixedText Text>
+std::uint32_t static_text_id() {
+  static const std::uint32_t id = StaticTextName(Text.view()).id();
+  return id;
+}
+
+} // namespace detail
+
+namespace Library {
+
+// Text that never changes, such as the " is " that `Office` writes after the person's
+// name: `out() << static_text<" is ">` stores it in a binary record as its 4-byte id,
+// which it's interned with on first use, rather than copying its characters. It's
+// written like any other text otherwise.
+struct StaticText {
+  std::string_view text;
+  std::uint32_t  (*id)(); // interns `text` on the first call
+};
+
+template<detail::FixedText Text>
+inline constexpr StaticText static_text{Text.view(), &detail::static_text_id<Text>};
+
+// What `out()` returns. It writes to the record in progress as text, through a
+// `std::ostream`, or, while a `BinaryLog` is active, as raw values.
+class OutputStream {
+public:
+  OutputStream(const OutputStream&)            = delete;
+  OutputStream& operator=(const OutputStream&) = delete;
+
+  OutputStream& operator<<(std::string_view text);
+  OutputStream& operator<<(const char* text) { return *this << std::string_view(text); }
+  OutputStream& operator<<(const std::string& text) { return *this << std::string_view(text); }
+  OutputStream& operator<<(Name name);
+  OutputStream& operator<<(StaticText text);
+  OutputStream& operator<<(char c);
+  OutputStream& operator<<(double value);
+  template<typename T>
+    requires (std::is_integral_v<T> && !std::is_same_v<T, char> && !std::is_same_v<T, bool>)
+  OutputStream& operator<<(T value);
+
+private:
+  friend class detail::ThreadOutput;
+  explicit OutputStream(detail::ThreadOutput& output) noexcept : m_output(output) {}
+
+  detail::ThreadOutput& m_output;
+};
+
+} // namespace Library
+
+namespace detail {
+
+// Appends whatever is written to it to a `std::string`
+class StringAppender final : public std::streambuf {
+public:
+  explicit StringAppender(std::string& text) noexcept : m_text(text) {}
+
+protected:
+  int_type overflow(int_type c) override {
+    if (!traits_type::eq_int_type(c, traits_type::eof())) {
+      m_text.push_back(traits_type::to_char_type(c));
+    }
+    return traits_type::not_eof(c);
+  }
+  std::streamsize xsputn(const char* text, std::streamsize count) override {
+    m_text.append(text, static_cast<std::size_t>(count));
+    return count;
+  }
+
+private:
+  std::string& m_text;
+};
+
+struct OutputSettings {
+  static OutputSettings& instance() noexcept {
+    static OutputSettings settings;
+    return settings;
+  }
+
+  static Library::OutputSink* default_sink() {
+    static Library::StreamSink sink;
+    return &sink;
+  }
+
+  std::atomic<Library::OutputSink*>          sink{nullptr}; // nullptr means `default_sink()`
+  std::atomic<Library::FlushPolicy::Mode>    mode{Library::FlushPolicy::Mode::PerRecord};
+  std::atomic<std::size_t>                   bytes{0};
+  std::atomic<std::chrono::nanoseconds::rep> interval{0};
+  std::atomic<Library::OutputSink*>          binary_sink{nullptr}; // of the active `BinaryLog`
+};
+
+// The records of one thread: the committed ones, followed by the one in progress.
+class ThreadOutput {
+public:
+  static ThreadOutput& instance() {
+    thread_local ThreadOutput output;
+    return output;
+  }
+
+  ~ThreadOutput() { flush(); }
+
+  Library::OutputStream& stream() noexcept { return m_out; }
+  [[nodiscard]] bool binary() const noexcept { return m_binary_sink != nullptr; }
+  std::ostream& text() noexcept { return m_stream; }
+  std::string& binary_record() noexcept { return m_binary_record; }
+
+  void begin() {
+    if (m_depth++ == 0) {
+      commit_stray();
+      Library::OutputSink* binary_sink = OutputSettings::instance().binary_sink.load(std::memory_order_acquire);
+      if (binary_sink != nullptr && m_binary_sink == nullptr) {
+        flush(); // the text records still pending come first
+      }
+      m_binary_sink = binary_sink;
+    }
+  }
+
+  void end(bool commit) {
+    if (--m_depth > 0) {
+      return;
+    }
+    if (m_binary_sink != nullptr) {
+      if (commit) {
+        push_binary_record();
+      }
+      m_binary_record.clear();
+      m_binary_sink = nullptr; // text written outside of a record is stray text
+      return;
+    }
+    if (!commit) {
+      m_text.resize(m_committed);
+      return;
+    }
+    if (m_text.size() == m_committed || m_text.back() != '\n') {
+      m_text.push_back('\n');
+    }
+    m_committed = m_text.size();
+    if (due()) {
+      flush();
+    }
+  }
+
+  void flush() {
+    if (m_depth == 0) {
+      commit_stray();
+    }
+    if (m_committed == 0) {
+      return;
+    }
+    OutputSettings& settings = OutputSettings::instance();
+    Library::OutputSink* sink = settings.sink.load(std::memory_order_acquire);
+    (sink != nullptr ? sink : settings.default_sink())->commit(std::string_view(m_text).substr(0, m_committed));
+    m_text.erase(0, m_committed);
+    m_committed = 0;
+    m_last_flush = std::chrono::steady_clock::now();
+  }
+
+private:
+  ThreadOutput() : m_appender(m_text), m_stream(&m_appender), m_out(*this) {}
+
+  // Commits the text written outside of any record as a record of its own, rather than
+  // let it start the next one.
+  void commit_stray() {
+    if (m_text.size() > m_committed) {
+      if (m_text.back() != '\n') {
+        m_text.push_back('\n');
+      }
+      m_committed = m_text.size();
+    }
+  }
+
+  // Waits for the `BinaryLog` to make room in the ring if needed. A record that the ring
+  // may not fit is rendered right away, once the log has committed the records before it
+  // to the sink (draining them isn't enough, as they may still be in its batch).
+  void push_binary_record() {
+    if (!m_ring) {
+      m_ring = RecordRings::instance().add();
+    }
+    if (!m_ring->fits(m_binary_record.size())) {
+      while (!m_ring->committed()) {
+        std::this_thread::yield();
+      }
+      std::string text;
+      render_record(m_binary_record, text);
+      m_binary_sink->commit(text);
+      return;
+    }
+    while (!m_ring->try_push(m_binary_record)) {
+      std::this_thread::yield();
+    }
+  }
+
+  [[nodiscard]] bool due() const {
+    const OutputSettings& settings = OutputSettings::instance();
+    switch (settings.mode.load(std::memory_order_relaxed)) {
+      case Library::FlushPolicy::Mode::PerRecord:
+        return true;
+      case Library::FlushPolicy::Mode::Size:
+        return m_committed >= settings.bytes.load(std::memory_order_relaxed);
+      case Library::FlushPolicy::Mode::Interval:
+        return m_committed >= settings.bytes.load(std::memory_order_relaxed)
+            || std::chrono::steady_clock::now() - m_last_flush
+                 >= std::chrono::nanoseconds(settings.interval.load(std::memory_order_relaxed));
+    }
+    return true;
+  }
+
+  std::string                           m_text;
+  std::size_t                           m_committed  = 0; // length of the committed records
+  int                                   m_depth      = 0; // of nested `OutputRecord`s
+  std::chrono::steady_clock::time_point m_last_flush = std::chrono::steady_clock::now();
+  StringAppender                        m_appender;
+  std::ostream                          m_stream;
+  Library::OutputStream                 m_out;
+  Library::OutputSink*                  m_binary_sink = nullptr; // for the current record
+  std::string                           m_binary_record;
+  std::shared_ptr<RecordRing>           m_ring;           // created on first use
+};
+
+} // namespace detail
+
+namespace Library {
+
+inline OutputSink::~OutputSink() {
+  OutputSink* self = this;
+  detail::OutputSettings::instance().sink.compare_exchange_strong(self, nullptr);
+}
+
+inline void set_output(OutputSink& sink, FlushPolicy policy) {
+  flush_output();
+  detail::OutputSettings& settings = detail::OutputSettings::instance();
+  settings.bytes.store(policy.bytes, std::memory_order_relaxed);
+  settings.interval.store(policy.interval.count(), std::memory_order_relaxed);
+  settings.mode.store(policy.mode, std::memory_order_relaxed);
+  settings.sink.store(&sink, std::memory_order_release);
+}
+
+inline void reset_output() {
+  flush_output();
+  detail::OutputSettings& settings = detail::OutputSettings::instance();
+  settings.mode.store(FlushPolicy::Mode::PerRecord, std::memory_order_relaxed);
+  settings.sink.store(nullptr, std::memory_order_release);
+}
+
+inline void flush_output() { detail::ThreadOutput::instance().flush(); }
+
+inline OutputStream& out() { return detail::ThreadOutput::instance().stream(); }
+
+inline OutputStream& OutputStream::operator<<(std::string_view text) {
+  if (m_output.binary()) {
+    detail::append_text(m_output.binary_record(), text);
+  } else {
+    m_output.text() << text;
+  }
+  return *this;
+}
+
+inline OutputStream& OutputStream::operator<<(Name name) {
+  if (m_output.binary()) {
+    detail::append_fragment(m_output.binary_record(), detail::FragmentTag::Name, name.id());
+  } else {
+    m_output.text() << name.view();
+  }
+  return *this;
+}
+
+inline OutputStream& OutputStream::operator<<(StaticText text) {
+  if (m_output.binary()) {
+    detail::append_fragment(m_output.binary_record(), detail::FragmentTag::Static, text.id());
+  } else {
+    m_output.text() << text.text;
+  }
+  return *this;
+}
+
+inline OutputStream& OutputStream::operator<<(char c) {
+  if (m_output.binary()) {
+    detail::append_fragment(m_output.binary_record(), detail::FragmentTag::Char, c);
+  } else {
+    m_output.text() << c;
+  }
+  return *this;
+}
+
+inline OutputStream& OutputStream::operator<<(double value) {
+  if (m_output.binary()) {
+    detail::append_fragment(m_output.binary_record(), detail::FragmentTag::Double, value);
+  } else {
+    m_output.text() << value;
+  }
+  return *this;
+}
+
+template<typename T>
+  requires (std::is_integral_v<T> && !std::is_same_v<T, char> && !std::is_same_v<T, bool>)
+OutputStream& OutputStream::operator<<(T value) {
+  if (m_output.binary()) {
+    if constexpr (std::is_signed_v<T>) {
+      detail::append_fragment(m_output.binary_record(), detail::FragmentTag::Signed, std::int64_t{value});
+    } else {
+      detail::append_fragment(m_output.binary_record(), detail::FragmentTag::Unsigned, std::uint64_t{value});
+    }
+  } else {
+    m_output.text() << value;
+  }
+  return *this;
+}
+
+inline OutputRecord::OutputRecord() : m_uncaught_exceptions(std::uncaught_exceptions()) {
+  detail::ThreadOutput::instance().begin();
+}
+
+inline OutputRecord::~OutputRecord() {
+  detail::ThreadOutput::instance().end(!m_dropped && std::uncaught_exceptions() == m_uncaught_exceptions);
+}
+
+} // namespace Library
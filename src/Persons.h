@@ -0,0 +1,44 @@
+#pragma once
+
+// `Library::Person` sub-classes used by the example in main.cpp. Note that their
+// `do_work()` methods have nothing in common but the name. They print to the record
+// that `Library::Office` started, which it ends with a newline, with their fixed text as
+// `Library::static_text`, which a `Library::BinaryLog` stores as ids.
+
+#include "Items.h"
+#include "Office.h"
+
+#include <span>
+
+class Cook : public Library::Person {
+public:
+  using Library::Person::Person;
+  void do_work(Recipe recipe, const IngredientList& ingredients) {
+    Library::out() << recipe.name() << Library::static_text<" with "> << ingredients.size()
+                   << Library::static_text<" ingredients: ">;
+    bool first = true;
+    for (const std::string_view i : ingredients) {
+      if (!first) {
+        Library::out() << Library::static_text<", ">;
+      }
+      Library::out() << i;
+      first = false;
+    }
+  }
+};
+
+class Programmer : public Library::Person {
+public:
+  using Library::Person::Person;
+  void do_work(Monitor monitor, Keyboard keyboard, Cup coffee) {
+    Library::out() << keyboard.name() << Library::static_text<", "> << monitor.name()
+                   << Library::static_text<", and "> << coffee.name();
+  }
+  // Preferred by `Library::Office::work_columns()` to calling `do_work()` for each row
+  void do_work_bulk(std::span<const Monitor> monitors, std::span<const Keyboard> keyboards,
+                    std::span<const Cup> coffees) {
+    Library::out() << keyboards.size() << Library::static_text<" keyboards, "> << monitors.size()
+                   << Library::static_text<" monitors, and "> << coffees.size()
+                   << Library::static_text<" coffees">;
+  }
+};
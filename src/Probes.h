@@ -0,0 +1,87 @@
+#pragma once
+
+// Optional USDT (user-level statically defined tracing) probes, for bpftrace, perf, or
+// SystemTap to trace the calls of a production binary without recompiling it:
+//   library:office_work_entry(name_id, signature_id, timestamp_ns)
+//     on entry to `Library::Office::work()`;
+//   library:invoke_work(name_id, signature_id, elapsed_ns)
+//     in `detail::PersonHolder::invoke_work()`, once the arguments have been checked,
+//     with the time taken since its entry, before calling `do_work()`;
+//   library:do_work_return(name_id, signature_id, elapsed_ns)
+//     when `do_work()` returns, with the time it took.
+// `name_id` is the `Library::Name::id()` of the person, `signature_id` a hash of the
+// names of the argument types, and the times come from `std::chrono::steady_clock`.
+// For example: bpftrace -e 'usdt:./Test:library:do_work_return { @[arg0] = hist(arg2); }'
+//
+// They are compiled in only when LIBRARY_USDT is 1 (the CMake option ENABLE_USDT), on
+// x86-64 and AArch64 ELF targets. Each probe is a `nop` with an ELF note describing it
+// in the format of <sys/sdt.h>, which is written here so as not to depend on it, and a
+// semaphore that tracers set when they attach to the probe: until then, the probe is
+// skipped, and its arguments, such as the clock reads, aren't computed.
+
+#include <chrono>
+#include <cstdint>
+
+#ifndef LIBRARY_USDT
+#define LIBRARY_USDT 0
+#endif
+
+#if LIBRARY_USDT && defined(__ELF__) && (defined(__x86_64__) || defined(__aarch64__))
+#define LIBRARY_HAS_USDT 1
+#else
+#define LIBRARY_HAS_USDT 0
+#endif
+
+#if LIBRARY_HAS_USDT
+
+// The semaphore of probe `name`, in the .probes section where tracers look for it. It's
+// a global with a plain (unmangled) name, so that the note can refer to it.
+#define LIBRARY_PROBE_SEMAPHORE(name) \
+  inline volatile unsigned short library_##name##_semaphore __attribute__((section(".probes"), used)) = 0
+
+// Whether a tracer is attached to probe `name`
+#define LIBRARY_PROBE_ENABLED(name) __builtin_expect(library_##name##_semaphore != 0, 0)
+
+// Fires probe `name` with three 64-bit arguments: a `nop`, and a note with its address,
+// its semaphore's, and where to find the arguments ("8@<operand>" each).
+#define LIBRARY_PROBE3(name, arg1, arg2, arg3)                                                 \
+  __asm__ __volatile__("990: nop\n"                                                             \
+                       ".pushsection .note.stapsdt,\"\",\"note\"\n"                             \
+                       ".balign 4\n"                                                            \
+                       ".4byte 992f-991f, 994f-993f, 3\n"                                       \
+                       "991: .asciz \"stapsdt\"\n"                                              \
+                       "992: .balign 4\n"                                                       \
+                       "993: .8byte 990b\n"                                                     \
+                       ".8byte _.stapsdt.base\n"                                                \
+                       ".8byte library_" #name "_semaphore\n"                                   \
+                       ".asciz \"library\"\n"                                                   \
+                       ".asciz \"" #name "\"\n"                                                 \
+                       ".asciz \"8@%0 8@%1 8@%2\"\n"                                            \
+                       "994: .balign 4\n"                                                       \
+                       ".popsection\n"                                                          \
+                       ".ifndef _.stapsdt.base\n"                                               \
+                       ".pushsection .stapsdt.base,\"aG\",\"progbits\",.stapsdt.base,comdat\n"  \
+                       ".weak _.stapsdt.base\n"                                                 \
+                       ".hidden _.stapsdt.base\n"                                               \
+                       "_.stapsdt.base: .space 1\n"                                             \
+                       ".size _.stapsdt.base, 1\n"                                              \
+                       ".popsection\n"                                                          \
+                       ".endif\n"                                                               \
+                       :                                                                        \
+                       : "nor"(std::uint64_t{arg1}), "nor"(std::uint64_t{arg2}),                \
+                         "nor"(std::uint64_t{arg3}))
+
+LIBRARY_PROBE_SEMAPHORE(office_work_entry);
+LIBRARY_PROBE_SEMAPHORE(invoke_work);
+LIBRARY_PROBE_SEMAPHORE(do_work_return);
+
+namespace detail {
+
+inline std::uint64_t probe_now() noexcept {
+  return static_cast<std::uint64_t>(
+    std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+} // namespace detail
+
+#endif // LIBRARY_HAS_USDT
@@ -0,0 +1,105 @@
+#pragma once
+
+// Compact type identifiers that don't need RTTI. `type_id<T>()` is the address of a
+// variable that each type `T` gets for itself, so comparing two of them is a single
+// pointer comparison (`std::type_info::operator==` may compare mangled names with
+// strcmp() when the types come from different shared objects), and types that the
+// compiler spells alike, such as `{anonymous}::Arg` in two translation units or classes
+// local to two functions, still get different ids.
+//
+// The limits are those of any variable's address: it isn't known before linking, so
+// ids can't be hashed at compile time, and it changes from run to run. And a type only
+// has one id across shared objects if the dynamic linker merges its variable, as it
+// does for symbols of default visibility on ELF; where it doesn't (hidden visibility,
+// Windows DLLs), the type has one id per shared object. So when two ids differ,
+// `same_type()` falls back to comparing the names, for the types whose name can't
+// stand for another type (see `is_spelled_uniquely()`); arguments of the other types
+// passed from another shared object are rejected as mismatched rather than wrongly
+// accepted.
+
+#include <cstdint>
+#include <initializer_list>
+#include <string_view>
+
+namespace detail {
+
+template<typename T>
+constexpr std::string_view function_name() noexcept {
+#if defined(_MSC_VER) && !defined(__clang__)
+  return __FUNCSIG__;
+#else
+  return __PRETTY_FUNCTION__;
+#endif
+}
+
+// `function_name<T>()` spells `T` between a prefix and a suffix that don't depend on
+// `T`, so measure them on a known type.
+constexpr std::string_view kProbeName       = "int";
+constexpr std::string_view kProbeFunction   = function_name<int>();
+constexpr std::size_t      kTypeNamePrefix  = kProbeFunction.find(kProbeName);
+constexpr std::size_t      kTypeNameSuffix  = kProbeFunction.size() - kTypeNamePrefix - kProbeName.size();
+static_assert(kTypeNamePrefix != std::string_view::npos, "unsupported compiler");
+
+constexpr std::uint64_t fnv1a(std::string_view text) noexcept {
+  std::uint64_t hash = 14695981039346656037ull;
+  for (const char c : text) {
+    hash ^= static_cast<unsigned char>(c);
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+
+// Whether no other type of the program can be spelled `name`. That rules out types in
+// anonymous namespaces, local to a function, unnamed or of lambdas, and the templates
+// instantiated with any of them, however GCC, Clang or MSVC spell them.
+constexpr bool is_spelled_uniquely(std::string_view name) noexcept {
+  for (const std::string_view marker : {"anonymous", "unnamed", "lambda", ")::", "`"}) {
+    if (name.find(marker) != std::string_view::npos) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// The variable whose address is the id of `T`. It's writable, so that linkers can't fold
+// the variables of different types together as they may identical constants.
+template<typename T>
+inline char type_tag = 0;
+
+} // namespace detail
+
+namespace Library {
+
+struct TypeId {
+  const void* value = nullptr;
+
+  friend constexpr bool operator==(TypeId a, TypeId b) noexcept { return a.value == b.value; }
+  friend constexpr bool operator!=(TypeId a, TypeId b) noexcept { return a.value != b.value; }
+};
+
+// Human-readable name of `T`, as spelled by the compiler.
+template<typename T>
+constexpr std::string_view type_name() noexcept {
+  constexpr std::string_view function = detail::function_name<T>();
+  return function.substr(detail::kTypeNamePrefix,
+                         function.size() - detail::kTypeNamePrefix - detail::kTypeNameSuffix);
+}
+
+template<typename T>
+constexpr TypeId type_id() noexcept {
+  return {&detail::type_tag<T>};
+}
+
+} // namespace Library
+
+namespace detail {
+
+// Whether the types of ids `a` and `b`, named `a_name` and `b_name`, are the same. The
+// names are only compared when the ids differ, i.e. for a type from another shared
+// object whose variable wasn't merged with ours, or for a different type.
+constexpr bool same_type(Library::TypeId a, std::string_view a_name,
+                         Library::TypeId b, std::string_view b_name) noexcept {
+  return a == b || (a_name == b_name && is_spelled_uniquely(a_name));
+}
+
+} // namespace detail
@@ -0,0 +1,146 @@
+#pragma once
+
+#include "ArgFrame.h"
+#include "TypeId.h"
+
+#include <algorithm>
+#include <any>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <string_view>
+
+// The library also builds with exceptions disabled (-fno-exceptions), in which case
+// `AnyPerson::work()` reports mismatched arguments and aborts; use `try_work()` to
+// handle them instead.
+#if defined(__cpp_exceptions) || defined(__EXCEPTIONS) || (defined(_MSC_VER) && defined(_CPPUNWIND))
+#define LIBRARY_HAS_EXCEPTIONS 1
+#else
+#define LIBRARY_HAS_EXCEPTIONS 0
+#endif
+
+namespace Library {
+
+enum class WorkStatus : std::uint8_t {
+  Ok,
+  ArityMismatch, // the number of arguments differs from that of `do_work()` parameters
+  TypeMismatch,  // an argument's (decayed) type differs from that of its parameter
+  Unsupported,   // the types match, but `do_work()` can't take the arguments this way
+                 // (e.g. batch items are passed by const reference)
+};
+
+// Outcome of `AnyPerson::try_work()`. It's as cheap to return as a few pointers and
+// refers to static data only.
+class WorkResult {
+public:
+  WorkResult() noexcept = default;
+  WorkResult(WorkStatus status, std::size_t index,
+             const detail::Signature& expected, const detail::Signature& actual) noexcept
+    : m_status(status), m_index(index), m_expected(&expected), m_actual(&actual) {}
+
+  [[nodiscard]] explicit operator bool() const noexcept { return m_status == WorkStatus::Ok; }
+  [[nodiscard]] WorkStatus status() const noexcept { return m_status; }
+
+  // The first argument that differs; if all the common ones match, the arities differ
+  // and `index()` is the arity of the shorter signature.
+  [[nodiscard]] std::size_t index() const noexcept { return m_index; }
+  // Types of the `do_work()` parameter and of the argument at `index()`; TypeId{} if
+  // there's none (or the work succeeded).
+  [[nodiscard]] TypeId expected() const noexcept { return type_at(m_expected); }
+  [[nodiscard]] TypeId actual()   const noexcept { return type_at(m_actual); }
+  [[nodiscard]] std::string_view expected_name() const noexcept { return name_at(m_expected); }
+  [[nodiscard]] std::string_view actual_name()   const noexcept { return name_at(m_actual); }
+  [[nodiscard]] std::size_t expected_arity() const noexcept { return m_expected ? m_expected->arity : 0; }
+  [[nodiscard]] std::size_t actual_arity()   const noexcept { return m_actual   ? m_actual->arity   : 0; }
+
+  // Describes the mismatch; allocates, so keep it off the hot path.
+  [[nodiscard]] std::string message() const {
+    switch (m_status) {
+      case WorkStatus::Ok:
+        return "ok";
+      case WorkStatus::ArityMismatch:
+        return "expected " + std::to_string(expected_arity()) + " arguments, got "
+             + std::to_string(actual_arity());
+      case WorkStatus::TypeMismatch:
+        return "argument " + std::to_string(m_index) + " should be " + std::string(expected_name())
+             + ", not " + std::string(actual_name());
+      case WorkStatus::Unsupported:
+        return "do_work() can't take the arguments this way";
+    }
+    return {};
+  }
+
+private:
+  [[nodiscard]] TypeId type_at(const detail::Signature* signature) const noexcept {
+    return signature && m_index < signature->arity ? signature->types[m_index] : TypeId{};
+  }
+  [[nodiscard]] std::string_view name_at(const detail::Signature* signature) const noexcept {
+    return signature && m_index < signature->arity ? signature->names[m_index] : std::string_view{};
+  }
+
+  WorkStatus                 m_status   = WorkStatus::Ok;
+  std::size_t                m_index    = 0;
+  const detail::Signature* m_expected = nullptr;
+  const detail::Signature* m_actual   = nullptr;
+};
+
+// Thrown by `AnyPerson::work()` when the arguments don't match the parameters of
+// `do_work()`. It's a `std::bad_any_cast` for the sake of code written against the
+// original `std::any`-based implementation.
+class BadWorkArguments : public std::bad_any_cast {
+public:
+  explicit BadWorkArguments(const WorkResult& result)
+    : m_result(result), m_message("AnyPerson::work(): " + result.message()) {}
+
+  [[nodiscard]] const char* what() const noexcept override { return m_message.c_str(); }
+  [[nodiscard]] const WorkResult& result() const noexcept { return m_result; }
+  [[nodiscard]] std::size_t index() const noexcept { return m_result.index(); }
+  [[nodiscard]] TypeId expected() const noexcept { return m_result.expected(); }
+  [[nodiscard]] TypeId actual()   const noexcept { return m_result.actual(); }
+
+private:
+  WorkResult  m_result;
+  std::string m_message;
+};
+
+} // namespace Library
+
+namespace detail {
+
+// Compares the signature of `do_work()` parameters with that of the arguments: a
+// single comparison of their addresses, unless they differ, in which case the types
+// are compared one by one to find the culprit (or find none, if a shared object has a
+// copy of the same signature).
+[[nodiscard]] inline Library::WorkResult check_arguments(const Signature& expected,
+                                                         const Signature& actual) noexcept {
+  if (&expected == &actual) {
+    return {};
+  }
+  const std::size_t common = std::min(expected.arity, actual.arity);
+  std::size_t index = 0;
+  while (index < common && same_type(expected.types[index], expected.names[index],
+                                     actual.types[index], actual.names[index])) {
+    ++index;
+  }
+  if (index == expected.arity && index == actual.arity) {
+    return {};
+  }
+  const auto status = index < common ? Library::WorkStatus::TypeMismatch
+                                     : Library::WorkStatus::ArityMismatch;
+  return {status, index, expected, actual};
+}
+
+// Throws `Library::BadWorkArguments`, or prints what went wrong and aborts when
+// exceptions are disabled.
+[[noreturn]] inline void raise_work_error(const Library::WorkResult& result) {
+#if LIBRARY_HAS_EXCEPTIONS
+  throw Library::BadWorkArguments(result);
+#else
+  std::cerr << "AnyPerson::work(): " << result.message() << std::endl;
+  std::abort();
+#endif
+}
+
+} // namespace detail
@@ -0,0 +1,109 @@
+#pragma once
+
+#include "WorkErrors.h"
+
+#include <atomic>
+#include <cassert>
+#include <exception>
+#include <utility>
+
+namespace detail {
+
+// Completion state shared by a `Library::WorkFuture` and the queued work it refers to,
+// which derives from it: the two hold one reference each, and the last one released
+// deletes the work. Waiting uses `std::atomic::wait()`, so the state needs neither a
+// mutex nor a condition variable.
+class AsyncState {
+public:
+  AsyncState() noexcept = default;
+  AsyncState(const AsyncState&)            = delete;
+  AsyncState& operator=(const AsyncState&) = delete;
+
+  [[nodiscard]] bool ready() const noexcept { return m_done.load(std::memory_order_acquire); }
+  void wait() const noexcept { m_done.wait(false, std::memory_order_acquire); }
+
+#if LIBRARY_HAS_EXCEPTIONS
+  // Rethrows what `do_work()` threw, if anything; only once the state is ready.
+  void rethrow_if_failed() const {
+    if (m_exception) {
+      std::rethrow_exception(m_exception);
+    }
+  }
+#endif
+
+  void release() noexcept {
+    if (m_references.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      delete this;
+    }
+  }
+
+protected:
+  virtual ~AsyncState() = default;
+
+#if LIBRARY_HAS_EXCEPTIONS
+  // Called by the work if `do_work()` threw, before `complete()`.
+  void fail(std::exception_ptr exception) noexcept { m_exception = std::move(exception); }
+#endif
+
+  // Called by the work once it has run, which gives up its reference.
+  void complete() noexcept {
+    m_done.store(true, std::memory_order_release);
+    m_done.notify_all();
+    release();
+  }
+
+private:
+  std::atomic<bool>          m_done{false};
+  std::atomic<unsigned char> m_references{2};
+#if LIBRARY_HAS_EXCEPTIONS
+  std::exception_ptr         m_exception;
+#endif
+};
+
+} // namespace detail
+
+namespace Library {
+
+// Handle to the completion of `Office::work_async()`. Unlike `std::future`, destroying
+// one doesn't wait for the work, which then runs detached.
+class WorkFuture {
+public:
+  WorkFuture() noexcept = default;
+  explicit WorkFuture(detail::AsyncState& state) noexcept : m_state(&state) {}
+
+  WorkFuture(WorkFuture&& other) noexcept : m_state(std::exchange(other.m_state, nullptr)) {}
+  WorkFuture& operator=(WorkFuture&& other) noexcept {
+    if (this != &other) {
+      reset();
+      m_state = std::exchange(other.m_state, nullptr);
+    }
+    return *this;
+  }
+  WorkFuture(const WorkFuture&)            = delete;
+  WorkFuture& operator=(const WorkFuture&) = delete;
+  ~WorkFuture() { reset(); }
+
+  // False for a default-constructed or moved-from future.
+  [[nodiscard]] bool valid() const noexcept { return m_state != nullptr; }
+  [[nodiscard]] bool ready() const noexcept { assert(valid()); return m_state->ready(); }
+  void wait() const noexcept { assert(valid()); m_state->wait(); }
+
+  // Waits for the work, then rethrows the exception `do_work()` threw, if any.
+  void get() const {
+    wait();
+#if LIBRARY_HAS_EXCEPTIONS
+    m_state->rethrow_if_failed();
+#endif
+  }
+
+private:
+  void reset() noexcept {
+    if (m_state != nullptr) {
+      std::exchange(m_state, nullptr)->release();
+    }
+  }
+
+  detail::AsyncState* m_state = nullptr;
+};
+
+} // namespace Library
@@ -0,0 +1,313 @@
+#pragma once
+
+// Optional instrumentation of `detail::PersonHolder::invoke_work()`: for each type of
+// person, how many calls went through to `do_work()`, how many were rejected for the
+// types of their arguments, how many for how they were passed, and a histogram of how
+// long the calls that went through took. It is compiled in only when
+// LIBRARY_WORK_STATS is 1 (the CMake option ENABLE_WORK_STATS); otherwise
+// `invoke_work()` is exactly what it is without it.
+//
+// Each thread records into shards of its own, one per type of person, without locking
+// nor read-modify-write instructions; `Library::work_stats()` merges the shards of all
+// threads, including those that have ended, on demand.
+
+#include "TypeId.h"
+#include "WorkErrors.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <vector>
+
+#ifndef LIBRARY_WORK_STATS
+#define LIBRARY_WORK_STATS 0
+#endif
+
+namespace detail { struct PersonShard; }
+
+namespace Library {
+
+// Log-linear histogram of latencies in nanoseconds, in the manner of HdrHistogram: a
+// bucket per nanosecond below 16 ns, and above, 16 buckets per power of two, so that a
+// bucket's bounds are within 1/16 of each other whatever the magnitude.
+class LatencyHistogram {
+public:
+  static constexpr unsigned    kSubBucketBits = 4;
+  static constexpr std::size_t kSubBuckets    = std::size_t{1} << kSubBucketBits;
+  static constexpr std::size_t kBucketCount   = (64 - kSubBucketBits + 1) * kSubBuckets;
+
+  static constexpr std::size_t bucket_of(std::uint64_t ns) noexcept {
+    if (ns < kSubBuckets) {
+      return ns;
+    }
+    const auto shift = static_cast<unsigned>(std::bit_width(ns)) - 1 - kSubBucketBits;
+    return (shift + 1) * kSubBuckets + ((ns >> shift) & (kSubBuckets - 1));
+  }
+  static constexpr std::uint64_t lower_bound(std::size_t bucket) noexcept {
+    if (bucket < kSubBuckets) {
+      return bucket;
+    }
+    return std::uint64_t{kSubBuckets + bucket % kSubBuckets} << (bucket / kSubBuckets - 1);
+  }
+  static constexpr std::uint64_t upper_bound(std::size_t bucket) noexcept {
+    return bucket + 1 == kBucketCount ? UINT64_MAX : lower_bound(bucket + 1) - 1;
+  }
+
+  void record(std::uint64_t ns) noexcept {
+    ++m_buckets[bucket_of(ns)];
+    ++m_count;
+    m_sum += ns;
+    m_min = std::min(m_min, ns);
+    m_max = std::max(m_max, ns);
+  }
+
+  void merge(const LatencyHistogram& other) noexcept {
+    for (std::size_t i = 0; i < kBucketCount; ++i) {
+      m_buckets[i] += other.m_buckets[i];
+    }
+    m_count += other.m_count;
+    m_sum   += other.m_sum;
+    m_min    = std::min(m_min, other.m_min);
+    m_max    = std::max(m_max, other.m_max);
+  }
+
+  [[nodiscard]] std::uint64_t count() const noexcept { return m_count; }
+  [[nodiscard]] std::uint64_t count(std::size_t bucket) const noexcept { return m_buckets[bucket]; }
+  [[nodiscard]] std::uint64_t min() const noexcept { return m_count == 0 ? 0 : m_min; }
+  [[nodiscard]] std::uint64_t max() const noexcept { return m_max; }
+  [[nodiscard]] double mean() const noexcept {
+    return m_count == 0 ? 0.0 : static_cast<double>(m_sum) / static_cast<double>(m_count);
+  }
+
+  // The latency that a fraction `quantile` (from 0 to 1) of the recorded ones don't
+  // exceed, to the upper bound of its bucket
+  [[nodiscard]] std::uint64_t percentile(double quantile) const noexcept {
+    if (m_count == 0) {
+      return 0;
+    }
+    const auto rank = std::max<std::uint64_t>(
+      1, static_cast<std::uint64_t>(std::clamp(quantile, 0.0, 1.0) * static_cast<double>(m_count) + 0.5));
+    std::uint64_t seen = 0;
+    for (std::size_t i = 0; i < kBucketCount; ++i) {
+      seen += m_buckets[i];
+      if (seen >= rank) {
+        return std::min(upper_bound(i), m_max);
+      }
+    }
+    return m_max;
+  }
+
+private:
+  friend struct detail::PersonShard;
+
+  std::array<std::uint64_t, kBucketCount> m_buckets{};
+  std::uint64_t                           m_count = 0;
+  std::uint64_t                           m_sum   = 0;
+  std::uint64_t                           m_min   = UINT64_MAX;
+  std::uint64_t                           m_max   = 0;
+};
+
+struct PersonStats {
+  TypeId           type;            // of the person
+  std::string_view person;          // the name of its type, e.g. "Cook"
+  std::uint64_t    calls       = 0; // that reached `do_work()`
+  std::uint64_t    mismatches  = 0; // rejected for the types or number of their arguments
+  std::uint64_t    unsupported = 0; // whose arguments `do_work()` can't take as passed
+  LatencyHistogram latency;         // of the calls that reached `do_work()`
+};
+
+// The stats of each type of person that `invoke_work()` was called on, merged over all
+// threads, in the order of their first calls. Empty unless LIBRARY_WORK_STATS is 1.
+[[nodiscard]] std::vector<PersonStats> work_stats();
+
+} // namespace Library
+
+namespace detail {
+
+// What one thread recorded for one type of person. Only that thread writes it, with
+// relaxed loads and stores, which cost what plain ones do; `work_stats()` may read it
+// from another thread at any time.
+struct PersonShard {
+  std::atomic<std::uint64_t>                                                calls{0};
+  std::atomic<std::uint64_t>                                                mismatches{0};
+  std::atomic<std::uint64_t>                                                unsupported{0};
+  std::atomic<std::uint64_t>                                                sum{0};
+  std::atomic<std::uint64_t>                                                min{UINT64_MAX};
+  std::atomic<std::uint64_t>                                                max{0};
+  std::array<std::atomic<std::uint64_t>, Library::LatencyHistogram::kBucketCount> buckets{};
+
+  static void add(std::atomic<std::uint64_t>& counter, std::uint64_t value) noexcept {
+    counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+  }
+
+  void record_call(std::uint64_t ns) noexcept {
+    add(calls, 1);
+    add(sum, ns);
+    add(buckets[Library::LatencyHistogram::bucket_of(ns)], 1);
+    if (ns < min.load(std::memory_order_relaxed)) {
+      min.store(ns, std::memory_order_relaxed);
+    }
+    if (ns > max.load(std::memory_order_relaxed)) {
+      max.store(ns, std::memory_order_relaxed);
+    }
+  }
+
+  void merge_into(Library::PersonStats& stats) const noexcept {
+    stats.calls       += calls.load(std::memory_order_relaxed);
+    stats.mismatches  += mismatches.load(std::memory_order_relaxed);
+    stats.unsupported += unsupported.load(std::memory_order_relaxed);
+    Library::LatencyHistogram& latency = stats.latency;
+    for (std::size_t i = 0; i < buckets.size(); ++i) {
+      const std::uint64_t count = buckets[i].load(std::memory_order_relaxed);
+      latency.m_buckets[i] += count;
+      latency.m_count      += count;
+    }
+    latency.m_sum += sum.load(std::memory_order_relaxed);
+    latency.m_min  = std::min(latency.m_min, min.load(std::memory_order_relaxed));
+    latency.m_max  = std::max(latency.m_max, max.load(std::memory_order_relaxed));
+  }
+};
+
+// The types of persons, each with a dense slot, and the shards of all threads. A thread
+// takes a set of shards when it first records, and gives it back when it ends, for the
+// next new thread to take over, counts included.
+class WorkStatsRegistry {
+public:
+  static constexpr std::size_t kMaxPersonTypes = 1024; // the others aren't recorded
+
+  static WorkStatsRegistry& instance() {
+    static WorkStatsRegistry registry;
+    return registry;
+  }
+
+  // The slot of the type of person `type`, named `name`, which is added if it's new
+  std::size_t slot_of(Library::TypeId type, std::string_view name) {
+    const std::lock_guard<std::mutex> lock(m_mutex);
+    const auto found = std::find_if(m_persons.begin(), m_persons.end(),
+                                    [type](const PersonType& person) { return person.type == type; });
+    if (found != m_persons.end()) {
+      return static_cast<std::size_t>(found - m_persons.begin());
+    }
+    m_persons.push_back({type, name});
+    return m_persons.size() - 1;
+  }
+
+  // The calling thread's shard for the type of person in `slot`, or nullptr if there
+  // are too many types
+  static PersonShard* shard(std::size_t slot) {
+    if (slot >= kMaxPersonTypes) {
+      return nullptr;
+    }
+    thread_local const Lease lease(instance().acquire());
+    std::atomic<PersonShard*>& entry = lease.shards->shards[slot];
+    if (PersonShard* shard = entry.load(std::memory_order_relaxed)) {
+      return shard;
+    }
+    auto* shard = new PersonShard;
+    entry.store(shard, std::memory_order_release);
+    return shard;
+  }
+
+  std::vector<Library::PersonStats> snapshot() {
+    const std::lock_guard<std::mutex> lock(m_mutex);
+    std::vector<Library::PersonStats> stats(m_persons.size());
+    for (std::size_t slot = 0; slot < stats.size(); ++slot) {
+      stats[slot].type   = m_persons[slot].type;
+      stats[slot].person = m_persons[slot].name;
+    }
+    for (const auto& shards : m_shards) {
+      for (std::size_t slot = 0; slot < std::min(stats.size(), kMaxPersonTypes); ++slot) {
+        if (const PersonShard* shard = shards->shards[slot].load(std::memory_order_acquire)) {
+          shard->merge_into(stats[slot]);
+        }
+      }
+    }
+    return stats;
+  }
+
+private:
+  struct PersonType {
+    Library::TypeId  type;
+    std::string_view name;
+  };
+
+  struct ThreadShards {
+    ~ThreadShards() {
+      for (auto& shard : shards) {
+        delete shard.load(std::memory_order_relaxed);
+      }
+    }
+    std::array<std::atomic<PersonShard*>, kMaxPersonTypes> shards{};
+    bool                                                   in_use = true; // under the mutex
+  };
+
+  struct Lease {
+    explicit Lease(ThreadShards* taken) noexcept : shards(taken) {}
+    ~Lease() {
+      const std::lock_guard<std::mutex> lock(instance().m_mutex);
+      shards->in_use = false;
+    }
+    ThreadShards* shards;
+  };
+
+  ThreadShards* acquire() {
+    const std::lock_guard<std::mutex> lock(m_mutex);
+    for (const auto& shards : m_shards) {
+      if (!shards->in_use) {
+        shards->in_use = true;
+        return shards.get();
+      }
+    }
+    m_shards.push_back(std::make_unique<ThreadShards>());
+    return m_shards.back().get();
+  }
+
+  std::mutex                                 m_mutex;
+  std::vector<PersonType>                    m_persons; // by slot
+  std::vector<std::unique_ptr<ThreadShards>> m_shards;
+};
+
+inline std::uint64_t work_stats_now() noexcept {
+  return static_cast<std::uint64_t>(
+    std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+// Records a call of `invoke_work()` on a person of the type in `slot`, which started at
+// `start` (from `work_stats_now()`), and which ended with `status`.
+inline void record_work(std::size_t slot, Library::WorkStatus status, std::uint64_t start) {
+  if (PersonShard* shard = WorkStatsRegistry::shard(slot)) {
+    switch (status) {
+      case Library::WorkStatus::Ok:
+        shard->record_call(work_stats_now() - start);
+        break;
+      case Library::WorkStatus::ArityMismatch:
+      case Library::WorkStatus::TypeMismatch:
+        PersonShard::add(shard->mismatches, 1);
+        break;
+      case Library::WorkStatus::Unsupported:
+        PersonShard::add(shard->unsupported, 1);
+        break;
+    }
+  }
+}
+
+} // namespace detail
+
+namespace Library {
+
+inline std::vector<PersonStats> work_stats() {
+#if LIBRARY_WORK_STATS
+  return detail::WorkStatsRegistry::instance().snapshot();
+#else
+  return {};
+#endif
+}
+
+} // namespace Library
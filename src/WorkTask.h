@@ -0,0 +1,160 @@
+#pragma once
+
+#include "BlockPool.h"
+#include "WorkErrors.h"
+
+#include <atomic>
+#include <coroutine>
+#include <exception>
+#include <utility>
+
+namespace detail {
+template<typename P, typename... Args>
+struct PersonHolder;
+} // namespace detail
+
+namespace Library {
+
+// What `Office::work()` returns, and what a person's `do_work()` may return instead of
+// `void` to be a coroutine, e.g. one that `co_await`s I/O or a timer rather than block
+// its thread. Such a `do_work()` starts right away, runs until it first suspends, and
+// hands back the `WorkTask`, which the caller can `co_await` (or poll with `ready()`).
+// A `WorkTask` destroyed before the work is done leaves it running detached. For a
+// `do_work()` that returns `void`, the task is empty and always ready.
+//
+// The coroutine shares the ownership of its person with the `Office` or `AnyPerson`,
+// which keeps a coroutine person on the heap: the person stays where it is, and alive,
+// until the last of them is gone, so the `Office` may be moved, or be a temporary as in
+// `Office{Courier{"Carol", timers}}.work(Parcel{})`, while the work is in progress. What
+// else the coroutine refers to, such as the `timers`, must outlive it.
+//
+// Coroutine frames are allocated from `detail::BlockPool`, so that the frames of
+// finished work are recycled rather than freed.
+class WorkTask {
+public:
+  class promise_type : public detail::PoolAllocated {
+  public:
+    WorkTask get_return_object() noexcept { return WorkTask(Handle::from_promise(*this)); }
+    std::suspend_never initial_suspend() const noexcept { return {}; }
+    auto final_suspend() const noexcept { return FinalAwaiter{}; }
+    void return_void() const noexcept {}
+
+    ~promise_type() {
+      if (m_release != nullptr) {
+        m_release(m_owner);
+      }
+    }
+
+    void unhandled_exception() noexcept {
+#if LIBRARY_HAS_EXCEPTIONS
+      m_exception = std::current_exception();
+#else
+      std::terminate();
+#endif
+    }
+
+  private:
+    friend class WorkTask;
+
+    // Resumes the coroutine awaiting the work, or destroys a detached one.
+    struct FinalAwaiter {
+      bool await_ready() const noexcept { return false; }
+      void await_resume() const noexcept {}
+      std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> handle) const noexcept {
+        void* previous = handle.promise().m_state.exchange(done(), std::memory_order_acq_rel);
+        if (previous == detached()) {
+          handle.destroy();
+        } else if (previous != nullptr) {
+          return std::coroutine_handle<>::from_address(previous);
+        }
+        return std::noop_coroutine();
+      }
+    };
+
+    // nullptr while running, then the address of the awaiting coroutine, `done()` or
+    // `detached()`
+    std::atomic<void*> m_state{nullptr};
+#if LIBRARY_HAS_EXCEPTIONS
+    std::exception_ptr m_exception;
+#endif
+    // What the coroutine keeps alive, see `keep_alive()`
+    void* m_owner = nullptr;
+    void (*m_release)(void*) noexcept = nullptr;
+  };
+
+  WorkTask() noexcept = default;
+  WorkTask(WorkTask&& other) noexcept : m_handle(std::exchange(other.m_handle, nullptr)) {}
+  WorkTask& operator=(WorkTask&& other) noexcept {
+    if (this != &other) {
+      reset();
+      m_handle = std::exchange(other.m_handle, nullptr);
+    }
+    return *this;
+  }
+  WorkTask(const WorkTask&)            = delete;
+  WorkTask& operator=(const WorkTask&) = delete;
+  ~WorkTask() { reset(); }
+
+  [[nodiscard]] bool ready() const noexcept {
+    return !m_handle || m_handle.promise().m_state.load(std::memory_order_acquire) == done();
+  }
+
+  bool await_ready() const noexcept { return ready(); }
+  bool await_suspend(std::coroutine_handle<> awaiting) const noexcept {
+    void* expected = nullptr;
+    // Fails if the work got done in the meantime, in which case `awaiting` goes on.
+    return m_handle.promise().m_state.compare_exchange_strong(expected, awaiting.address(),
+                                                              std::memory_order_acq_rel);
+  }
+  // Rethrows what `do_work()` threw, if anything.
+  void await_resume() const {
+#if LIBRARY_HAS_EXCEPTIONS
+    if (m_handle && m_handle.promise().m_exception) {
+      std::rethrow_exception(m_handle.promise().m_exception);
+    }
+#endif
+  }
+
+private:
+  using Handle = std::coroutine_handle<promise_type>;
+
+  template<typename P, typename... Args>
+  friend struct detail::PersonHolder;
+
+  // Has the coroutine keep `owner` alive, calling `release(owner)` once its frame is
+  // destroyed. Returns false, leaving `owner` alone, if there's no coroutine, as when a
+  // `do_work()` that isn't one returns an empty task.
+  bool keep_alive(void* owner, void (*release)(void*) noexcept) noexcept {
+    if (!m_handle) {
+      return false;
+    }
+    m_handle.promise().m_owner   = owner;
+    m_handle.promise().m_release = release;
+    return true;
+  }
+
+  explicit WorkTask(Handle handle) noexcept : m_handle(handle) {}
+
+  static void* done() noexcept {
+    static char sentinel;
+    return &sentinel;
+  }
+  static void* detached() noexcept {
+    static char sentinel;
+    return &sentinel;
+  }
+
+  void reset() noexcept {
+    if (const Handle handle = std::exchange(m_handle, nullptr)) {
+      // Once done, the coroutine stays suspended at its end for us to destroy it;
+      // otherwise it will destroy itself.
+      if (handle.promise().m_state.exchange(detached(), std::memory_order_acq_rel) == done()) {
+        handle.destroy();
+      }
+    }
+  }
+
+  Handle m_handle;
+};
+
+} // namespace Library